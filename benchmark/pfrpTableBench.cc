@@ -0,0 +1,363 @@
+/*
+ * @Date         : 2026-10-19 10:00:00
+ * @FilePath     : RL4Net++/benchmark/pfrpTableBench.cc
+ * @Description  : Standalone microbenchmarks for the hot paths of pfrpTable. The table is driven with synthetic
+ *                 packet streams, without the OMNeT++ event loop, and a stub ZMQ peer answers in place of the
+ *                 python agent. Every topology runs in a forked child because pfrpTable is a process-wide singleton.
+ *
+ *                 usage: ./pfrpTableBench [-r bits] [topology ...]
+ *                 topology is Gridnet, Nsfnet or a node count of a generated topology, default: all of
+ *                 Gridnet Nsfnet 100 1000 5000
+ *                 -r selects the probResolution of the table (0, 16 or 32), default: 0
+ */
+#include "pfrpTable.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <sstream>
+#include <streambuf>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+
+// count the heap allocations of the benchmark thread only, the stub peer allocates in its own thread
+static std::atomic<uint64_t> allocBytes{0};
+static std::atomic<uint64_t> allocCount{0};
+static thread_local bool countAlloc = false;
+
+void *operator new(size_t size)
+{
+    if (countAlloc)
+    {
+        allocBytes += size;
+        allocCount++;
+    }
+    void *p = malloc(size ? size : 1);
+    if (!p)
+        throw std::bad_alloc();
+    return p;
+}
+
+void operator delete(void *p) noexcept
+{
+    free(p);
+}
+
+void operator delete(void *p, size_t) noexcept
+{
+    free(p);
+}
+
+struct Topology
+{
+    string name;
+    string probFile;
+    int nodeNum = 0;
+    vector<vector<int>> prob;
+};
+
+/**
+ * @description: Read a probability file in the format read by pfrpTable::getProb.
+ * @param {Topology} &topo  topology whose probFile and nodeNum are set
+ * @return {bool}           whether the file could be read
+ */
+static bool readProb(Topology &topo)
+{
+    ifstream file(topo.probFile);
+    if (!file)
+        return false;
+    topo.prob.assign(topo.nodeNum, vector<int>(topo.nodeNum, 0));
+    for (int i = 0; i < topo.nodeNum; i++)
+        for (int j = 0; j < topo.nodeNum; j++)
+        {
+            string value;
+            getline(file, value, ',');
+            topo.prob[i][j] = atoi(value.c_str());
+        }
+    return true;
+}
+
+/**
+ * @description: Generate a connected topology with an average degree of about 4:
+ *               a ring plus random chords, with equal initial forwarding probabilities.
+ * @param {int} nodeNum     number of routers
+ * @return {Topology}       topology written to a temporary probability file
+ */
+static Topology generateTopology(int nodeNum)
+{
+    Topology topo;
+    topo.name = "Random" + to_string(nodeNum);
+    topo.nodeNum = nodeNum;
+    topo.probFile = "/tmp/pfrpTableBench_" + to_string(nodeNum) + ".txt";
+
+    std::mt19937 gen(nodeNum);
+    vector<vector<int>> adj(nodeNum, vector<int>(nodeNum, 0));
+    for (int i = 0; i < nodeNum; i++)
+    {
+        adj[i][(i + 1) % nodeNum] = adj[(i + 1) % nodeNum][i] = 1;
+    }
+    std::uniform_int_distribution<int> dist(0, nodeNum - 1);
+    for (int k = 0; k < nodeNum; k++)
+    {
+        int a = dist(gen), b = dist(gen);
+        if (a != b)
+            adj[a][b] = adj[b][a] = 1;
+    }
+
+    topo.prob.assign(nodeNum, vector<int>(nodeNum, 0));
+    FILE *file = fopen(topo.probFile.c_str(), "w");
+    for (int i = 0; i < nodeNum; i++)
+    {
+        int degree = 0;
+        for (int j = 0; j < nodeNum; j++)
+            degree += adj[i][j];
+        for (int j = 0; j < nodeNum; j++)
+        {
+            topo.prob[i][j] = adj[i][j] ? 100 / degree : 0;
+            fprintf(file, (i == nodeNum - 1 && j == nodeNum - 1) ? "%d" : "%d,", topo.prob[i][j]);
+        }
+    }
+    fclose(file);
+    return topo;
+}
+
+/**
+ * @description: Answer the REQ socket of pfrpTable with a fixed action, like a python agent that never learns.
+ * @param {int} port        port the stub peer binds to
+ * @param {string} action   reply to state messages
+ * @return {*} None
+ */
+static void stubPeer(int port, string action)
+{
+    zmq::context_t context{1};
+    zmq::socket_t socket{context, ZMQ_REP};
+    socket.bind("tcp://*:" + to_string(port));
+    while (true)
+    {
+        zmq::message_t request;
+        socket.recv(&request);
+        const char *data = (const char *)request.data();
+        string reply = (request.size() > 0 && data[0] == 's') ? action : "reward received";
+        zmq::message_t response{reply.size()};
+        memcpy(response.data(), reply.data(), reply.size());
+        socket.send(response);
+    }
+}
+
+/**
+ * @description: Run an operation a number of times and print ns and heap bytes per operation.
+ * @param {char} *name  name of the operation
+ * @param {long} ops    number of operations done by one call of f
+ * @param {F} f         the operation
+ * @return {*} None
+ */
+template <typename F>
+static void measure(const char *name, long ops, F f)
+{
+    allocBytes = 0;
+    allocCount = 0;
+    countAlloc = true;
+    auto start = std::chrono::steady_clock::now();
+    f();
+    auto end = std::chrono::steady_clock::now();
+    countAlloc = false;
+    double ns = std::chrono::duration<double, std::nano>(end - start).count();
+    printf("  %-24s %10ld ops %14.1f ns/op %12.1f B/op %8.2f allocs/op\n", name, ops, ns / ops,
+           double(allocBytes) / ops, double(allocCount) / ops);
+    fflush(stdout);
+}
+
+/**
+ * @description: Benchmark one topology under one simulation mode.
+ * @param {Topology} &topo  topology to benchmark
+ * @param {int} simMode     1 for single-agent DRL, 2 for multi-agent DRL
+ * @param {int} port        port of the stub peer
+ * @param {int} resolution  probResolution of the table
+ * @return {*} None
+ */
+static void runBench(const Topology &topo, int simMode, int port, int resolution)
+{
+    int nodeNum = topo.nodeNum;
+    long cells = long(nodeNum) * nodeNum;
+    // keep the big topologies to a few seconds per operation
+    int updateSteps = int(std::max(2L, std::min(50L, 20000000L / cells)));
+    int endSteps = 50;
+    int totalStep = updateSteps + endSteps + 2;
+    long routeOps = 1000000;
+    int pktPerStep = 2000;
+
+    string action;
+    if (simMode == 1)
+    {
+        int edgeNum = 0;
+        for (int i = 0; i < nodeNum; i++)
+            for (int j = i; j < nodeNum; j++)
+                if (topo.prob[i][j])
+                    edgeNum++;
+        for (int e = 0; e < edgeNum * 2; e++)
+            action += (e ? ",1.0" : "1.0");
+    }
+    else
+    {
+        for (int i = 0; i < nodeNum; i++)
+            for (int j = 0; j < nodeNum; j++)
+                action += ((i || j) ? "," : "") + to_string(topo.prob[i][j]);
+    }
+    std::thread(stubPeer, port, action).detach();
+
+    // errors only, so that the reward lines queued for the writer thread are not part of the numbers
+    pfrpTelemetry::getInstance()->configure(pfrpTelemetry::LEVEL_ERROR, "", "", 0);
+
+    pfrpTable *table = pfrpTable::initTable(nodeNum, topo.probFile.c_str(), port, 2.0, totalStep, simMode);
+    table->setSeed(5000);
+    table->setProbResolution(resolution);
+
+    // synthetic packet stream: (current router, destination) pairs, never delivered to a local host
+    std::mt19937 gen(5000);
+    std::uniform_int_distribution<int> node(0, nodeNum - 1);
+    const int streamLen = 4096;
+    vector<int> curNodes, dstNodes;
+    vector<string> paths, names;
+    for (int k = 0; k < streamLen; k++)
+    {
+        int cur = node(gen), dst = node(gen);
+        while (dst == cur)
+            dst = node(gen);
+        curNodes.push_back(cur);
+        dstNodes.push_back(dst);
+        paths.push_back("Bench.R" + to_string(cur) + ".ipv4");
+        names.push_back("H" + to_string(cur) + "-H" + to_string(dst) + (simMode == 1 ? "-pfrpsa-" : "-pfrpma-") +
+                        to_string(k) + "-" + to_string(updateSteps));
+    }
+    vector<int> nextNodes(streamLen);
+
+    printf("%s (%d nodes), simMode %d, probResolution %d\n", topo.name.c_str(), nodeNum, simMode, resolution);
+
+    long sink = 0;
+    measure("getNextNode", routeOps, [&]() {
+        for (long k = 0; k < routeOps; k++)
+            sink += table->getNextNode(curNodes[k % streamLen], dstNodes[k % streamLen]);
+    });
+    for (int k = 0; k < streamLen; k++)
+        nextNodes[k] = table->getNextNode(curNodes[k], dstNodes[k]);
+    measure("getGateId", routeOps, [&]() {
+        for (long k = 0; k < routeOps; k++)
+            sink += table->getGateId(curNodes[k % streamLen], nextNodes[k % streamLen]);
+    });
+    measure("getRoute", routeOps, [&]() {
+        for (long k = 0; k < routeOps; k++)
+            sink += table->getRoute(paths[k % streamLen], names[k % streamLen].c_str(), 1024).second;
+    });
+
+    // one operation = the state/action exchange of a whole step, triggered by the last of nodeNum routers
+    measure("updateProb", updateSteps, [&]() {
+        for (int step = 0; step < updateSteps; step++)
+        {
+            for (int k = 0; k < streamLen; k++)
+                table->countPkct(curNodes[k], nextNodes[k], 1024);
+            for (int i = 0; i < nodeNum; i++)
+                table->stepEndRecord(step, 2.0 * (step + 1));
+            for (int i = 0; i < nodeNum; i++)
+                table->updateProb(step);
+        }
+    });
+
+    if (simMode == 1)
+    {
+        // delayWithStep grows one step at a time, so every step gets its first delay in order
+        for (int step = 0; step < totalStep; step++)
+            table->setDelayWithStep(step, 0.01, 0.0);
+        measure("setDelayWithStep", long(endSteps) * pktPerStep, [&]() {
+            for (int step = updateSteps; step < updateSteps + endSteps; step++)
+                for (int k = 0; k < pktPerStep; k++)
+                    table->setDelayWithStep(step, 0.01 + k * 1e-6, 0.0);
+        });
+        for (int step = updateSteps; step < updateSteps + endSteps; step++)
+            table->pkNumRecord(pktPerStep + 100, step);
+        table->endStep(updateSteps + endSteps); // the first finished step is discarded without an exchange
+        measure("endStep", endSteps, [&]() {
+            for (int step = updateSteps; step < updateSteps + endSteps; step++)
+                table->endStep(step);
+        });
+    }
+    else
+    {
+        measure("countPktInNode", long(endSteps) * pktPerStep, [&]() {
+            for (int step = updateSteps; step < updateSteps + endSteps; step++)
+            {
+                for (int k = 0; k < pktPerStep; k++)
+                {
+                    string name = "H0-H1-pfrpma-" + to_string(k) + "-" + to_string(step);
+                    table->countPktInNode(paths[k % streamLen], name.c_str());
+                }
+            }
+        });
+        for (int step = updateSteps; step < updateSteps + endSteps; step++)
+            for (int k = 0; k < pktPerStep; k += 2)
+                table->countPktDelay(step, k, 0.01);
+        table->endStepMulti(updateSteps + endSteps);
+        measure("endStepMulti", endSteps, [&]() {
+            for (int step = updateSteps; step < updateSteps + endSteps; step++)
+                table->endStepMulti(step);
+        });
+    }
+
+    if (sink == 42)
+        printf("\n");
+}
+
+int main(int argc, char **argv)
+{
+    vector<string> names;
+    int resolution = 0;
+    for (int i = 1; i < argc; i++)
+    {
+        if (string(argv[i]) == "-r" && i + 1 < argc)
+            resolution = atoi(argv[++i]);
+        else
+            names.push_back(argv[i]);
+    }
+    if (names.empty())
+        names = {"Gridnet", "Nsfnet", "100", "1000", "5000"};
+
+    int port = 5600;
+    for (const string &name : names)
+    {
+        Topology topo;
+        if (name == "Gridnet" || name == "Nsfnet")
+        {
+            topo.name = name;
+            topo.nodeNum = name == "Gridnet" ? 9 : 13;
+            topo.probFile = "../config/ned/" + name + ".txt";
+            if (!readProb(topo))
+            {
+                fprintf(stderr, "cannot read %s\n", topo.probFile.c_str());
+                return 1;
+            }
+        }
+        else
+        {
+            topo = generateTopology(atoi(name.c_str()));
+        }
+
+        for (int simMode = 1; simMode <= 2; simMode++)
+        {
+            pid_t pid = fork();
+            if (pid == 0)
+            {
+                runBench(topo, simMode, port, resolution);
+                _exit(0);
+            }
+            int status = 0;
+            waitpid(pid, &status, 0);
+            if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+                fprintf(stderr, "%s simMode %d failed\n", topo.name.c_str(), simMode);
+            port++;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,95 @@
+/*
+ * @Date         : 2026-10-19 19:00:00
+ * @FilePath     : RL4Net++/benchmark/pfrpTableCheck.cc
+ * @Description  : Standalone checks of the pfrpTable set-up done by UdpPfrpApp::initialize, without the OMNeT++
+ *                 event loop. Every check runs in a forked child because pfrpTable is a process-wide singleton.
+ *
+ *                 usage: ./pfrpTableCheck
+ *                 the exit code is the number of failed checks
+ */
+#include "pfrpTable.h"
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include <sys/wait.h>
+#include <unistd.h>
+
+/**
+ * @description: Read a whole file.
+ * @param {string} &path    file to read
+ * @return {string}         content of the file, empty if it cannot be read
+ */
+static string readFile(const string &path)
+{
+    ifstream file(path);
+    stringstream content;
+    content << file.rdbuf();
+    return content.str();
+}
+
+/**
+ * @description: Set up a K shortest paths table with a telemetry file, like an application of simMode 3 does.
+ * @param {bool} configureFirst whether the telemetry is configured before the pfrpTable setters,
+ *                              otherwise the log of setPathCount starts the writer before configure is called
+ * @return {int}                0 if the log of setPathCount went to the telemetry file
+ */
+static int checkPathTelemetry(bool configureFirst)
+{
+    string logFile = "/tmp/pfrpTableCheck_" + to_string(getpid()) + ".log";
+    pfrpTelemetry *telemetry = pfrpTelemetry::getInstance();
+    if (configureFirst)
+        telemetry->configure(pfrpTelemetry::LEVEL_INFO, logFile.c_str(), "", 0);
+    pfrpTable *table = pfrpTable::initTable(9, "../config/ned/Gridnet.txt", 5700, 2.0, 10, 3);
+    table->setPathCount(3, "");
+    if (!configureFirst)
+        telemetry->configure(pfrpTelemetry::LEVEL_INFO, logFile.c_str(), "", 0);
+    telemetry->log(pfrpTelemetry::LEVEL_INFO, "---- check ----");
+    telemetry->flush();
+
+    string log = readFile(logFile);
+    remove(logFile.c_str());
+    if (log.find("---- check ----") == string::npos)
+    {
+        fprintf(stderr, "telemetryFile is ignored after setPathCount\n");
+        return 1;
+    }
+    if (configureFirst && log.find("---- paths ----") == string::npos)
+    {
+        fprintf(stderr, "the paths of setPathCount are missing from telemetryFile\n");
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * @description: Run a check in a forked child.
+ * @param {char} *name  name printed with the result
+ * @param {F} f         the check, returns 0 on success
+ * @return {int}        0 on success
+ */
+template <typename F>
+static int runCheck(const char *name, F f)
+{
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+        // the log of the table goes to stdout until the telemetry is configured
+        if (!freopen("/dev/null", "w", stdout))
+            _exit(1);
+        _exit(f());
+    }
+    int status = 0;
+    waitpid(pid, &status, 0);
+    bool passed = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    printf("%-40s %s\n", name, passed ? "ok" : "FAILED");
+    return passed ? 0 : 1;
+}
+
+int main()
+{
+    int failed = 0;
+    failed += runCheck("telemetryFile with pathCount", []() { return checkPathTelemetry(true); });
+    failed += runCheck("telemetryFile configured after pathCount", []() { return checkPathTelemetry(false); });
+    return failed;
+}
@@ -0,0 +1,275 @@
+"""
+Date         : 2026-10-19 11:00:00
+FilePath     : RL4Net++/benchmark/sim_bench.py
+Description  : End-to-end simulation throughput benchmark. Runs the configurations of config/omnetpp.ini in Cmdenv
+               across a sweep of flowRate, simMode and stepTime, with a stand-in agent that answers the ZMQ REQ
+               socket of pfrpTable with a fixed action. Reports events per second, wall time per simulated step,
+               the ZMQ round-trip latency distribution and the peak RSS of the simulation process.
+               The round trips are taken from the timing records of pfrpTable when INET is built with
+               PFRP_TIMING, and estimated with a loopback probe otherwise.
+
+               usage: python benchmark/sim_bench.py [--networks Gridnet Nsfnet] [--sim-modes 0 1 2] ...
+               run it after `. setenv` of omnetpp and inet, so that the `inet` command is available.
+"""
+
+import argparse
+import contextlib
+import itertools
+import json
+import math
+import os
+import re
+import subprocess
+import threading
+import time
+
+import zmq
+
+CONFIG_DIR = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "config")
+
+
+def read_prob_file(network):
+    """read the initial probability table of a network
+
+    Args:
+        network (string): name of the network, config/ned/{network}.txt must exist
+
+    Returns:
+        list: flattened nodeNum x nodeNum probability matrix
+    """
+    with open(os.path.join(CONFIG_DIR, "ned", f"{network}.txt")) as f:
+        return [int(p) for p in f.read().strip().split(",")]
+
+
+def fixed_action(prob, sim_mode):
+    """build the action the stand-in agent sends after every state message
+
+    Args:
+        prob (list):    flattened initial probability matrix
+        sim_mode (int): simulation mode
+
+    Returns:
+        string: equal link weights for single-agent DRL, the initial table otherwise
+    """
+    node_num = int(round(math.sqrt(len(prob))))
+    if sim_mode == 1:
+        edge_num = sum(
+            1 for i in range(node_num) for j in range(i, node_num) if prob[i * node_num + j]
+        )
+        return ",".join(["1.0"] * (edge_num * 2))
+    return ",".join(str(p) for p in prob)
+
+
+def percentile(values, q):
+    """get the q-th percentile of a list of values, None if the list is empty"""
+    if not values:
+        return None
+    values = sorted(values)
+    return values[min(len(values) - 1, int(round(q / 100 * (len(values) - 1))))]
+
+
+class StubAgent(threading.Thread):
+    """Answers the simulator with a fixed action and records when every message arrives."""
+
+    def __init__(self, port, action):
+        super().__init__(daemon=True)
+        self.port = port
+        self.action = action
+        self.arrivals = []  # (wall time, "s" or "r", step, message size)
+        self.stopped = threading.Event()
+        self.context = zmq.Context()
+        self.socket = self.context.socket(zmq.REP)
+        self.socket.bind(f"tcp://*:{self.port}")
+
+    def run(self):
+        poller = zmq.Poller()
+        poller.register(self.socket, zmq.POLLIN)
+        while not self.stopped.is_set():
+            if not poller.poll(100):
+                continue
+            request = self.socket.recv()
+            now = time.perf_counter()
+            head = request[:32].decode(errors="ignore").split("@@")
+            s_or_r = head[0]
+            step = int(head[1]) if len(head) > 1 and head[1].isdigit() else -1
+            self.arrivals.append((now, s_or_r, step, len(request)))
+            self.socket.send_string(self.action if s_or_r == "s" else "reward received")
+
+    def stop(self):
+        self.stopped.set()
+        self.join()
+        self.socket.close(linger=0)
+        self.context.term()
+
+    def step_wall_times(self):
+        """wall time between the messages of consecutive steps, state messages if any, rewards otherwise"""
+        kind = "s" if any(a[1] == "s" for a in self.arrivals) else "r"
+        times = [a[0] for a in self.arrivals if a[1] == kind]
+        return [b - a for a, b in zip(times, times[1:])]
+
+
+def read_timing_rtts(timing_file):
+    """read the simulator-side ZMQ round trips from the timing records of pfrpTable
+
+    Args:
+        timing_file (string): JSON lines file written by pfrpTable when built with PFRP_TIMING
+
+    Returns:
+        list: mean round trip of the exchanges of every step, unit: s
+    """
+    rtts = []
+    if not os.path.exists(timing_file):
+        return rtts
+    with open(timing_file) as f:
+        for line in f:
+            wait = json.loads(line)["zmqWait"]
+            if wait["calls"]:
+                rtts.append(wait["ns"] / wait["calls"] / 1e9)
+    return rtts
+
+
+def probe_zmq_rtt(port, size, count=200):
+    """measure REQ/REP round trips over loopback TCP with messages of the observed state size
+
+    Used when the simulator is built without PFRP_TIMING and does not record its own waits:
+    the round trip it sees is estimated by replaying messages of the same size over the same transport.
+
+    Returns:
+        list: round-trip latencies, unit: s
+    """
+    context = zmq.Context()
+    rep = context.socket(zmq.REP)
+    rep.bind(f"tcp://*:{port}")
+    req = context.socket(zmq.REQ)
+    req.connect(f"tcp://localhost:{port}")
+    payload = b"0" * max(size, 1)
+    rtts = []
+    for _ in range(count):
+        start = time.perf_counter()
+        req.send(payload)
+        rep.send(rep.recv()[:16])
+        req.recv()
+        rtts.append(time.perf_counter() - start)
+    req.close(linger=0)
+    rep.close(linger=0)
+    context.term()
+    return rtts
+
+
+def run_once(network, flow_rate, sim_mode, step_time, total_step, port):
+    """run one simulation with a stand-in agent
+
+    Returns:
+        dictionary: measurements of the run
+    """
+    prob = read_prob_file(network)
+    node_num = int(round(math.sqrt(len(prob))))
+    timing_file = os.path.abspath(f"sim_bench_timing_{os.getpid()}.jsonl")
+    with contextlib.suppress(FileNotFoundError):
+        os.remove(timing_file)
+    agent = StubAgent(port, fixed_action(prob, sim_mode))
+    agent.start()
+
+    cmd = [
+        "inet",
+        "-u",
+        "Cmdenv",
+        "-f",
+        "omnetpp.ini",
+        f"--network={network}",
+        f"--**.app[0].nodeNum={node_num}",
+        f'--**.app[0].routingFileName="ned/{network}.txt"',
+        f"--**.app[0].simMode={sim_mode}",
+        f"--**.app[0].flowRate={flow_rate}",
+        f"--**.app[0].stepTime={step_time}",
+        f"--**.app[0].totalStep={total_step}",
+        f"--**.app[0].zmqPort={port}",
+        f'--**.app[0].timingFile="{timing_file}"',
+        f"--sim-time-limit={(total_step + 2) * step_time}s",
+        "--cmdenv-express-mode=true",
+        "--cmdenv-status-frequency=1s",
+    ]
+    if sim_mode:
+        # pfrp runs skip the static routes of the configurator
+        cmd[1:1] = ["-c", "Pfrp"]
+    start = time.perf_counter()
+    proc = subprocess.Popen(cmd, cwd=CONFIG_DIR, stdout=subprocess.PIPE, stderr=subprocess.STDOUT)
+    output = proc.stdout.read().decode(errors="ignore")
+    _, status, rusage = os.wait4(proc.pid, 0)
+    wall = time.perf_counter() - start
+    agent.stop()
+
+    events = [int(e) for e in re.findall(r"Event #(\d+)", output)]
+    elapsed = [float(e) for e in re.findall(r"Elapsed: ([\d.]+)s", output)]
+    step_walls = agent.step_wall_times()
+    sizes = [a[3] for a in agent.arrivals if a[1] == "s"] or [a[3] for a in agent.arrivals]
+    rtts = read_timing_rtts(timing_file)
+    rtt_source = "simulator"
+    if not rtts:
+        rtts = probe_zmq_rtt(port + 1, max(sizes) if sizes else 0)
+        rtt_source = "probe"
+    with contextlib.suppress(FileNotFoundError):
+        os.remove(timing_file)
+
+    return {
+        "network": network,
+        "flowRate": flow_rate,
+        "simMode": sim_mode,
+        "stepTime": step_time,
+        "exitCode": os.waitstatus_to_exitcode(status) if hasattr(os, "waitstatus_to_exitcode") else status,
+        "events": events[-1] if events else None,
+        "eventsPerSec": events[-1] / elapsed[-1] if events and elapsed and elapsed[-1] > 0 else None,
+        "wallTime": wall,
+        "stepWallMean": sum(step_walls) / len(step_walls) if step_walls else None,
+        "stepWallP90": percentile(step_walls, 90),
+        "zmqRttP50": percentile(rtts, 50),
+        "zmqRttP90": percentile(rtts, 90),
+        "zmqRttP99": percentile(rtts, 99),
+        "zmqRttSource": rtt_source,
+        "messages": len(agent.arrivals),
+        "peakRssMB": rusage.ru_maxrss / 1024,
+    }
+
+
+def fmt(value, scale=1.0, digits=1):
+    return "-" if value is None else f"{value * scale:.{digits}f}"
+
+
+def main():
+    parser = argparse.ArgumentParser(description="End-to-end simulation throughput benchmark.")
+    parser.add_argument("--networks", nargs="+", default=["Gridnet", "Nsfnet"])
+    parser.add_argument("--flow-rates", nargs="+", type=float, default=[0.2, 0.5])
+    parser.add_argument("--sim-modes", nargs="+", type=int, default=[0, 1, 2])
+    parser.add_argument("--step-times", nargs="+", type=int, default=[2])
+    parser.add_argument("--total-step", type=int, default=10)
+    parser.add_argument("--port", type=int, default=5555)
+    parser.add_argument("--json", help="also write the results to this file")
+    args = parser.parse_args()
+
+    results = []
+    print(
+        f"{'network':<10}{'flow':>6}{'mode':>5}{'step':>5}{'events':>11}{'ev/s':>11}{'wall s':>9}"
+        f"{'step ms':>10}{'step p90':>10}{'rtt p50 us':>11}{'rtt p99 us':>11}{'rss MB':>9}"
+    )
+    for network, flow_rate, sim_mode, step_time in itertools.product(
+        args.networks, args.flow_rates, args.sim_modes, args.step_times
+    ):
+        r = run_once(network, flow_rate, sim_mode, step_time, args.total_step, args.port)
+        results.append(r)
+        print(
+            f"{network:<10}{flow_rate:>6}{sim_mode:>5}{step_time:>5}{fmt(r['events'], digits=0):>11}"
+            f"{fmt(r['eventsPerSec'], digits=0):>11}{fmt(r['wallTime']):>9}{fmt(r['stepWallMean'], 1e3):>10}"
+            f"{fmt(r['stepWallP90'], 1e3):>10}{fmt(r['zmqRttP50'], 1e6):>11}{fmt(r['zmqRttP99'], 1e6):>11}"
+            f"{fmt(r['peakRssMB']):>9}",
+            flush=True,
+        )
+        if r["exitCode"]:
+            print(f"  simulation exited with {r['exitCode']}")
+
+    if args.json:
+        with open(args.json, "w") as f:
+            json.dump(results, f, indent=2)
+
+
+if __name__ == "__main__":
+    main()
@@ -18,6 +18,8 @@ current_path=$(pwd)
 cp -r ./modules/omnetpp/* $omnetpp_path/src/sim/
 cp -r ./modules/inet/ipv4/* $inet_path/src/inet/networklayer/ipv4/
 cp -r ./modules/inet/udpapp/* $inet_path/src/inet/applications/udpapp/
+cp -r ./modules/inet/node/* $inet_path/src/inet/node/inet/
+cp -r ./modules/inet/queueing/* $inet_path/src/inet/queueing/queue/
 
 # compile omnetpp and inet
 cd $omnetpp_path
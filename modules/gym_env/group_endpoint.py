@@ -0,0 +1,91 @@
+"""
+Date         : 2026-10-19 16:00:00
+FilePath     : RL4Net++/modules/gym_env/group_endpoint.py
+Description  : Agent endpoint of a group of routers in multi-agent DRL with agentGroups > 0 in omnetpp.ini.
+               Each group is served by its own process on port zmqPort + 1 + g, so that the agents of different
+               groups run concurrently. The simulator sends one message per router of the group and expects one
+               reply per message, in any order:
+                   state  "s@@step@@node@@t_0,...,t_(nodeNum-1)[@@qlen=...@@qdelay=...][@@detour=...]"
+                          -> "node@@p_0,...,p_(nodeNum-1)"
+                   reward "r@@step@@node@@avgDelay,lossRate[@@drop=...@@dropttl=...@@dropst=...@@dropearly=...]"
+                          -> any acknowledgement
+               The detour and drop blocks (detourStats, dropStats) are those of the whole network, repeated for every
+               router.
+"""
+
+import zmq
+
+
+def group_routers(node_num, groups, group):
+    """get the routers served by a group
+
+    Args:
+        node_num (int): number of nodes of the topology
+        groups (int):   agentGroups in omnetpp.ini
+        group (int):    index of the group
+
+    Returns:
+        range: IDs of the routers of the group
+    """
+    return range((group * node_num + groups - 1) // groups, ((group + 1) * node_num + groups - 1) // groups)
+
+
+class GroupEndpoint:
+    """ROUTER socket answering the routers of one group."""
+
+    def __init__(self, group, port=5555):
+        """bind the endpoint of a group
+
+        Args:
+            group (int): index of the group
+            port (int):  zmqPort in omnetpp.ini
+        """
+        self.group = group
+        self.context = zmq.Context()
+        self.socket = self.context.socket(zmq.ROUTER)
+        self.socket.bind(f"tcp://*:{port + 1 + group}")
+        self.blocks = {}
+
+    def recv(self):
+        """receive the message of one router
+
+        Returns:
+            bytes: identity of the sender, to be passed back to send_row or ack
+            string: flag for state or reward, "s" means state, while "r" means reward
+            int: step of the message
+            int: ID of the router
+            list: traffic row of the router for a state, [avgDelay, lossRate] for a reward
+
+        Optional blocks of a state, the queue occupancy of the outgoing links of the router
+        in ascending neighbor order and the detour counts, and of a reward, the drop counts, are stored in self.blocks.
+        """
+        identity, request = self.socket.recv_multipart()
+        req = request.decode().split("@@")
+        self.blocks = {}
+        for block in req[4:]:
+            name, _, values = block.partition("=")
+            self.blocks[name] = [float(value) for value in values.split(",")] if values else []
+        return identity, req[0], int(req[1]), int(req[2]), [float(value) for value in req[3].split(",")]
+
+    def send_row(self, identity, node, row):
+        """answer a state with the new allProb row of the router
+
+        Args:
+            identity (bytes): identity returned by recv
+            node (int):       ID of the router
+            row (list):       forwarding probabilities of the router to every node, fractional values
+                              take effect with probResolution 16 or 32
+        """
+        self.socket.send_multipart([identity, f"{node}@@{','.join(str(p) for p in row)}".encode()])
+
+    def ack(self, identity):
+        """acknowledge a reward
+
+        Args:
+            identity (bytes): identity returned by recv
+        """
+        self.socket.send_multipart([identity, b"reward received"])
+
+    def close(self):
+        self.socket.close(linger=0)
+        self.context.term()
@@ -14,6 +14,8 @@ import signal
 import gym
 import zmq
 
+from .shm_transport import ShmTransport
+
 
 class OmnetEnv(gym.Env):
     def __init__(self):
@@ -23,12 +25,42 @@ class OmnetEnv(gym.Env):
         self.context = zmq.Context()
         self.socket = self.context.socket(zmq.REP)
         self.is_multi_agent = True
+        self.blocks = {}
+        # set to the shmName of UdpPfrpApp to exchange messages through /dev/shm instead of ZMQ
+        self.shm_name = None
+        self.transport = None
 
     def start_zmq_socket(self):
-        """start zmq socket"""
+        """start zmq socket, or create the shared-memory region if shm_name is set"""
+        if self.shm_name:
+            if self.transport:
+                self.transport.close()
+            self.transport = ShmTransport(self.shm_name)
+            return
         with contextlib.suppress(Exception):
             self.socket.bind(f"tcp://*:{str(self.port)}")
 
+    def recv_message(self):
+        """receive a message from omnetpp
+
+        Returns:
+            string: the message
+        """
+        if self.transport:
+            return self.transport.recv().decode()
+        return self.socket.recv().decode()
+
+    def send_message(self, message):
+        """send a message to omnetpp
+
+        Args:
+            message (string): the message
+        """
+        if self.transport:
+            self.transport.send(message)
+        else:
+            self.socket.send_string(message)
+
     def reset(self):
         """reset omnetpp environment"""
         print("env resetting ...")
@@ -58,18 +90,37 @@ class OmnetEnv(gym.Env):
             string: Flag for state or reward. "s" means state, while "r" means reward.
             int   : Step for the current message.
             list  : State list or reward value
+
+        Optional blocks following the message body, such as the per-link queue occupancy
+        "qlen=..." and "qdelay=..." or the hop counters "detour=...", are stored in self.blocks.
         """
-        request = self.socket.recv()
-        req = str(request).split("@@")
-        s_or_r = req[0][2:]
+        request = self.recv_message()
+        req = request.split("@@")
+        s_or_r = req[0]
         step = int(req[1])
         if not self.is_multi_agent and s_or_r == "s":
-            msg = [float(state) for state in req[2][:-1].split(",")]
+            msg = [float(state) for state in req[2].split(",")]
         else:
-            msg = req[2][:-1]
+            msg = req[2]
+        self.blocks = self.get_blocks(req[3:])
 
         return s_or_r, step, msg
 
+    def get_blocks(self, block_strs):
+        """convert optional message blocks to a dictionary
+
+        Args:
+            block_strs (list): blocks in the format of "name=v1,v2,..."
+
+        Returns:
+            dictionary: block name to list of values
+        """
+        blocks = {}
+        for block in block_strs:
+            name, _, values = block.partition("=")
+            blocks[name] = [float(value) for value in values.split(",")] if values else []
+        return blocks
+
     def get_states(self, state_str):
         """convert state messages to state matrix
 
@@ -132,15 +183,44 @@ class OmnetEnv(gym.Env):
         Args:
             action (string): forwarding probability of all links
         """
-        self.socket.send_string(action)
+        self.send_message(action)
+
+    def make_delta_action(self, entries):
+        """make a sparse action in omnetpp, only the given links change and only their rows are renormalized
+
+        Args:
+            entries (list): (edge id, weight) pairs for single-agent DRL, (row, col, value) triples for
+                            multi-agent DRL, (path id, weight) pairs for path-based DRL (simMode 3),
+                            an empty list keeps the current table, link weights and values must be positive
+        """
+        self.send_message("d@@" + ";".join(",".join(str(v) for v in entry) for entry in entries))
+
+    def get_paths(self, path_file):
+        """read the paths of simMode 3 from the pathFile written by omnetpp at startup
+
+        Args:
+            path_file (string): pathFile in omnetpp.ini
+
+        Returns:
+            list: (src, dst, index, routers) of every path in the order of the path ids, the action
+                  of simMode 3 is one split weight per path in this order
+        """
+        paths = []
+        with open(path_file, "r") as f:
+            for line in f:
+                if line.startswith("#"):
+                    continue
+                _, src, dst, index, routers = line.strip().split(",")
+                paths.append((int(src), int(dst), int(index), [int(r) for r in routers.split()]))
+        return paths
 
     def render(self):
         pass
 
     def end_epsode(self):
         """inform omnetpp of the end of the current episode"""
-        self.socket.send_string("end episode")
+        self.send_message("end episode")
 
     def reward_rcvd(self):
         """inform omnetpp that python has already gotten the reward"""
-        self.socket.send_string("reward received")
+        self.send_message("reward received")
@@ -0,0 +1,112 @@
+"""
+Date         : 2026-10-19 15:00:00
+FilePath     : RL4Net++/modules/gym_env/shm_transport.py
+Description  : Shared-memory transport between the python agent and pfrpTable, an alternative to the ZMQ REP socket
+               for a simulator on the same host. See modules/inet/ipv4/pfrpShm.h for the layout of the region
+               and the doorbell protocol. The region is created here, before the simulator is started.
+"""
+
+import contextlib
+import ctypes
+import mmap
+import os
+import platform
+import struct
+import time
+
+HEADER_SIZE = 192
+REQUEST_SEQ, REQUEST_LEN = 64, 68
+REPLY_SEQ, REPLY_LEN = 128, 132
+
+FUTEX_WAIT, FUTEX_WAKE = 0, 1
+# python stores are plain stores, the reply is published before replySeq only under the x86 memory model
+SYS_FUTEX = {"x86_64": 202}
+
+_libc = ctypes.CDLL(None, use_errno=True)
+_libc.syscall.restype = ctypes.c_long
+
+
+class _Timespec(ctypes.Structure):
+    _fields_ = [("tv_sec", ctypes.c_long), ("tv_nsec", ctypes.c_long)]
+
+
+class ShmTransport:
+    """Request/reply channel over /dev/shm with futex doorbells, used in place of a zmq.REP socket."""
+
+    def __init__(self, name, capacity=64 * 1024 * 1024, spin_time=50e-6):
+        """create the shared region, replacing an old one of the same name
+
+        Args:
+            name (string):      name of the region under /dev/shm, the shmName of UdpPfrpApp
+            capacity (int):     bytes of each of the request and reply buffers
+            spin_time (float):  time to poll for a request before sleeping on the futex, unit: s
+        """
+        if platform.machine() not in SYS_FUTEX:
+            raise OSError(f"shared-memory transport is not supported on {platform.machine()}")
+        self.sys_futex = SYS_FUTEX[platform.machine()]
+        self.path = os.path.join("/dev/shm", name)
+        self.capacity = capacity
+        self.spin_time = spin_time
+        with contextlib.suppress(FileNotFoundError):
+            os.remove(self.path)
+        fd = os.open(self.path, os.O_CREAT | os.O_RDWR, 0o600)
+        try:
+            os.ftruncate(fd, HEADER_SIZE + 2 * capacity)
+            self.map = mmap.mmap(fd, HEADER_SIZE + 2 * capacity)
+        finally:
+            os.close(fd)
+        struct.pack_into("<4sII", self.map, 0, b"PFSM", 1, capacity)
+
+        self.request_seq = ctypes.c_uint32.from_buffer(self.map, REQUEST_SEQ)
+        self.request_len = ctypes.c_uint32.from_buffer(self.map, REQUEST_LEN)
+        self.reply_seq = ctypes.c_uint32.from_buffer(self.map, REPLY_SEQ)
+        self.reply_len = ctypes.c_uint32.from_buffer(self.map, REPLY_LEN)
+        self.view = memoryview(self.map)
+        self.handled = 0
+        self.timeout = _Timespec(0, 100_000_000)
+
+    def recv(self):
+        """block until the simulator sends a request
+
+        Returns:
+            bytes: the request, copied out of the shared region like zmq.Socket.recv, so that no view of the
+                   region outlives close
+        """
+        start = time.perf_counter()
+        while True:
+            seq = self.request_seq.value
+            if seq != self.handled:
+                break
+            if time.perf_counter() - start > self.spin_time:
+                # sleeps only while requestSeq is unchanged, the timeout keeps the process interruptible
+                self._futex(self.request_seq, FUTEX_WAIT, seq, ctypes.byref(self.timeout))
+        self.handled = seq
+        return bytes(self.view[HEADER_SIZE : HEADER_SIZE + self.request_len.value])
+
+    def send(self, data):
+        """answer the last request
+
+        Args:
+            data (bytes or string): the reply
+        """
+        if isinstance(data, str):
+            data = data.encode()
+        if len(data) > self.capacity:
+            raise ValueError(f"reply of {len(data)} bytes exceeds the capacity of {self.capacity} bytes")
+        offset = HEADER_SIZE + self.capacity
+        self.view[offset : offset + len(data)] = data
+        self.reply_len.value = len(data)
+        # stored last, the simulator loads replySeq with acquire semantics
+        self.reply_seq.value = self.handled
+        self._futex(self.reply_seq, FUTEX_WAKE, 1, None)
+
+    def close(self):
+        """unmap and remove the shared region"""
+        self.view.release()
+        del self.request_seq, self.request_len, self.reply_seq, self.reply_len
+        self.map.close()
+        with contextlib.suppress(FileNotFoundError):
+            os.remove(self.path)
+
+    def _futex(self, word, op, value, timeout):
+        _libc.syscall(self.sys_futex, ctypes.c_void_p(ctypes.addressof(word)), op, value, timeout, None, 0)
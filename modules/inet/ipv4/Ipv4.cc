@@ -23,6 +23,7 @@
 #include "inet/common/LayeredProtocolBase.h"
 #include "inet/common/ModuleAccess.h"
 #include "inet/common/ProtocolTag_m.h"
+#include "inet/common/Simsignals.h"
 #include "inet/common/checksum/TcpIpChecksum.h"
 #include "inet/common/lifecycle/ModuleOperations.h"
 #include "inet/common/lifecycle/NodeStatus.h"
@@ -111,15 +112,62 @@ void Ipv4::initialize(int stage) {
         registerProtocol(Protocol::ipv4, gate("queueOut"), gate("transportOut"));
 
         survivalTime = par("survivalTime");
+        silentDrop = par("silentDrop");
+
+        // sample the ppp interface queues of routers, whose signals propagate up to the network node
+        queueState = par("queueState");
+        cModule *node = getContainingNode(this);
+        if (node->getName()[0] == 'R')
+            pfrpNodeId = pfrpTable::parseNodeId(node->getFullName());
+        if (queueState && pfrpNodeId >= 0) {
+            node->subscribe(packetPushedSignal, this);
+            node->subscribe(packetPoppedSignal, this);
+            node->subscribe(packetDroppedSignal, this);
+        }
+
+        // the routing table and the interface table emit their changes on the network node
+        int routeCacheSize = par("routeCacheSize");
+        if (routeCacheSize < 0 || (routeCacheSize & (routeCacheSize - 1)) != 0)
+            throw cRuntimeError("routeCacheSize must be 0 or a power of two, got %d", routeCacheSize);
+        if (routeCacheSize > 0) {
+            routeCache.assign(routeCacheSize, RouteCacheEntry());
+            while ((1 << routeCacheBits) < routeCacheSize)
+                routeCacheBits++;
+            node->subscribe(routeAddedSignal, this);
+            node->subscribe(routeDeletedSignal, this);
+            node->subscribe(routeChangedSignal, this);
+            node->subscribe(interfaceStateChangedSignal, this);
+            node->subscribe(interfaceIpv4ConfigChangedSignal, this);
+        }
 
         WATCH(numMulticast);
         WATCH(numLocalDeliver);
         WATCH(numDropped);
         WATCH(numUnroutable);
         WATCH(numForwarded);
+        WATCH(numRouteCacheHits);
+        WATCH(numRouteCacheMisses);
         WATCH_MAP(pendingPackets);
         WATCH_MAP(socketIdToSocketDescriptor);
     }
+    else if (stage == INITSTAGE_NETWORK_LAYER) {
+        // pfrpTable exists once every module has passed INITSTAGE_LOCAL
+        if (pfrpNodeId >= 0 && pfrpTable::isInitiated())
+            pfrpTable::getInstance()->checkDegree(pfrpNodeId, getContainingNode(this)->gateSize("pppg"));
+        earlyDrop = par("earlyDrop");
+        if (pfrpNodeId >= 0 && pfrpTable::isInitiated()) {
+            // report the links of the router for early drops and delay-weighted shortest paths,
+            // pppg[k] leads to its k-th neighbor in ascending ID order
+            if (earlyDrop)
+                pfrpTable::getInstance()->enableEarlyDrop();
+            cModule *node = getContainingNode(this);
+            for (int k = 0; k < node->gateSize("pppg"); k++) {
+                cDatarateChannel *channel = dynamic_cast<cDatarateChannel *>(node->gate("pppg$o", k)->getChannel());
+                if (channel != nullptr)
+                    pfrpTable::getInstance()->setLinkDelay(pfrpNodeId, k, channel->getDelay().dbl(), channel->getDatarate());
+            }
+        }
+    }
 }
 
 void Ipv4::handleRegisterService(const Protocol &protocol, cGate *out, ServicePrimitive servicePrimitive) {
@@ -531,7 +579,7 @@ void Ipv4::routeUnicastPacket(Packet *packet) {
             packet->addTagIfAbsent<InterfaceReq>()->setInterfaceId(destIE->getInterfaceId());
             packet->addTagIfAbsent<NextHopAddressReq>()->setNextHopAddress(next.toIpv4());
         } else { // no pfrp
-            const Ipv4Route *re = rt->findBestMatchingRoute(destAddr);
+            const Ipv4Route *re = findCachedRoute(destAddr);
             if (re) {
                 destIE = re->getInterface();
                 packet->addTagIfAbsent<InterfaceReq>()->setInterfaceId(destIE->getInterfaceId());
@@ -556,6 +604,23 @@ void Ipv4::routeUnicastPacket(Packet *packet) {
     }
 }
 
+const Ipv4Route *Ipv4::findCachedRoute(const Ipv4Address &destAddr) {
+    if (routeCache.empty())
+        return rt->findBestMatchingRoute(destAddr);
+    // Fibonacci hashing, the high bits of the product select the entry
+    uint32_t index = routeCacheBits ? (destAddr.getInt() * 2654435769u) >> (32 - routeCacheBits) : 0;
+    RouteCacheEntry &entry = routeCache[index];
+    if (entry.version == routeCacheVersion && entry.destAddr == destAddr) {
+        numRouteCacheHits++;
+        return entry.route;
+    }
+    numRouteCacheMisses++;
+    entry.destAddr = destAddr;
+    entry.route = rt->findBestMatchingRoute(destAddr);
+    entry.version = routeCacheVersion;
+    return entry.route;
+}
+
 void Ipv4::routeUnicastPacketFinish(Packet *packet) {
 
     EV_INFO << "output interface = " << getDestInterface(packet)->getInterfaceName() << ", next hop address = " << getNextHop(packet) << "\n";
@@ -832,26 +897,22 @@ void Ipv4::fragmentAndSend(Packet *packet) {
 
     // hop counter check
     if (ipv4Header->getTimeToLive() <= 0) {
-        // drop datagram, destruction responsibility in ICMP
-        PacketDropDetails details;
-        details.setReason(HOP_LIMIT_REACHED);
-        emit(packetDroppedSignal, packet, &details);
-        EV_WARN << "datagram TTL reached zero, sending ICMP_TIME_EXCEEDED\n";
-        sendIcmpError(packet, -1 /*TODO*/, ICMP_TIME_EXCEEDED, 0);
-        numDropped++;
+        dropExpiredDatagram(packet, destIE, pfrpTable::DROP_TTL);
         return;
     }
 
     // pfrp survivalTime
-    if (simTime().dbl() - packet->getCreationTime().dbl() >= survivalTime) {
-        // drop datagram, destruction responsibility in ICMP
-        PacketDropDetails details;
-        details.setReason(HOP_LIMIT_REACHED);
-        emit(packetDroppedSignal, packet, &details);
-        EV_WARN << "datagram TTL reached zero, sending ICMP_TIME_EXCEEDED\n";
+    double age = simTime().dbl() - packet->getCreationTime().dbl();
+    if (age >= survivalTime) {
+        dropExpiredDatagram(packet, destIE, pfrpTable::DROP_SURVIVAL);
+        return;
+    }
 
-        sendIcmpError(packet, -1 /*TODO*/, ICMP_TIME_EXCEEDED, 0);
-        numDropped++;
+    // pfrp early drop: the packet cannot reach its destination router within survivalTime any more,
+    // it would be dropped by the check above at a later router
+    if (earlyDrop && pfrpNodeId >= 0 && strstr(pktName, "pfrp") &&
+        pfrpTable::getInstance()->exceedsSurvival(pfrpNodeId, pktName, age, packet->getBitLength())) {
+        dropExpiredDatagram(packet, destIE, pfrpTable::DROP_EARLY);
         return;
     }
 
@@ -1353,6 +1414,61 @@ void Ipv4::receiveSignal(cComponent *source, simsignal_t signalID, cObject *obj,
     if (signalID == IArp::arpResolutionFailedSignal) {
         arpResolutionTimedOut(check_and_cast<IArp::Notification *>(obj));
     }
+    if (signalID == routeAddedSignal || signalID == routeDeletedSignal || signalID == routeChangedSignal ||
+        signalID == interfaceStateChangedSignal || signalID == interfaceIpv4ConfigChangedSignal) {
+        // every cached route may be stale, empty the whole cache at once
+        routeCacheVersion++;
+    }
+    if (queueState && (signalID == packetPushedSignal || signalID == packetPoppedSignal || signalID == packetDroppedSignal)) {
+        cModule *queue = dynamic_cast<cModule *>(source);
+        cModule *nic = queue != nullptr ? queue->getParentModule() : nullptr;
+        if (nic != nullptr && nic->isName("ppp"))
+            sampleInterfaceQueue(nic->getIndex(), signalID, obj);
+    }
+}
+
+void Ipv4::sampleInterfaceQueue(int pppIndex, simsignal_t signalID, cObject *obj) {
+    pfrpTable *table = pfrpTable::getInstance();
+    if (signalID == packetPushedSignal) {
+        queuePushTimes[obj] = simTime();
+        table->countQueueLength(pfrpNodeId, pppIndex, 1, simTime().dbl());
+        return;
+    }
+    auto it = queuePushTimes.find(obj);
+    if (it == queuePushTimes.end())
+        return; // not a queued packet, e.g. dropped by the interface before enqueueing
+    if (signalID == packetPoppedSignal)
+        table->countQueueDelay(pfrpNodeId, pppIndex, (simTime() - it->second).dbl());
+    queuePushTimes.erase(it);
+    table->countQueueLength(pfrpNodeId, pppIndex, -1, simTime().dbl());
+}
+
+void Ipv4::dropExpiredDatagram(Packet *packet, const InterfaceEntry *destIE, int reason) {
+    const char *pktName = packet->getFullName();
+    bool pfrp = strstr(pktName, "pfrp") != nullptr;
+    if (pfrp) {
+        // the ppp interface the packet was to leave on, interfaces of ppp[k] are named "ppp<k>"
+        int pppIndex = -1;
+        if (pfrpNodeId >= 0 && strncmp(destIE->getInterfaceName(), "ppp", 3) == 0)
+            pppIndex = atoi(destIE->getInterfaceName() + 3);
+        pfrpTable::getInstance()->countDrop(pfrpNodeId, pppIndex, pktName, reason);
+    }
+
+    PacketDropDetails details;
+    details.setReason(HOP_LIMIT_REACHED);
+    emit(packetDroppedSignal, packet, &details);
+    numDropped++;
+    if (pfrp && silentDrop) {
+        EV_WARN << "pfrp datagram expired, dropped without ICMP\n";
+        delete packet;
+        return;
+    }
+    // drop datagram, destruction responsibility in ICMP
+    if (reason == pfrpTable::DROP_EARLY)
+        EV_WARN << "datagram cannot arrive within survivalTime, sending ICMP_TIME_EXCEEDED\n";
+    else
+        EV_WARN << "datagram TTL reached zero, sending ICMP_TIME_EXCEEDED\n";
+    sendIcmpError(packet, -1 /*TODO*/, ICMP_TIME_EXCEEDED, 0);
 }
 
 void Ipv4::sendIcmpError(Packet *origPacket, int inputInterfaceId, IcmpType type, IcmpCode code) {
@@ -22,6 +22,8 @@
 #include <list>
 #include <map>
 #include <set>
+#include <unordered_map>
+#include <vector>
 
 #include "inet/common/INETDefs.h"
 #include "inet/common/IProtocolRegistrationListener.h"
@@ -41,6 +43,7 @@ class ArpPacket;
 class IcmpHeader;
 class IInterfaceTable;
 class IIpv4RoutingTable;
+class Ipv4Route;
 // class IIpv4PfrpRoutingTable;
 
 /**
@@ -111,6 +114,29 @@ class INET_API Ipv4 : public OperationalBase, public NetfilterBase, public INetw
     typedef std::list<QueuedDatagramForHook> DatagramQueueForHooks;
     DatagramQueueForHooks queuedDatagramsForHooks;
 
+    // pfrp early drop of packets that cannot arrive within survivalTime
+    bool earlyDrop = false;
+
+    // pfrp packets over their TTL or survivalTime are deleted instead of answered with ICMP
+    bool silentDrop = false;
+
+    // pfrp interface queue sampling
+    bool queueState = false;
+    int pfrpNodeId = -1; // ID of the router in pfrpTable, -1 for hosts
+    std::unordered_map<const cObject *, simtime_t> queuePushTimes; // packets waiting in the ppp queues
+
+    // direct-mapped cache of the routes of non-pfrp unicast destinations, entries of an older version are empty
+    struct RouteCacheEntry {
+        Ipv4Address destAddr;
+        const Ipv4Route *route = nullptr; // nullptr if no route matches
+        uint32_t version = 0;
+    };
+    std::vector<RouteCacheEntry> routeCache; // empty if routeCacheSize is 0
+    int routeCacheBits = 0;                  // log2 of the entries
+    uint32_t routeCacheVersion = 1;          // incremented whenever the routing table or an interface changes
+    long numRouteCacheHits = 0;
+    long numRouteCacheMisses = 0;
+
   protected:
     // utility: look up interface from getArrivalGate()
     virtual const InterfaceEntry *getSourceInterface(Packet *packet);
@@ -129,6 +155,15 @@ class INET_API Ipv4 : public OperationalBase, public NetfilterBase, public INetw
     // utility: processing requested ARP resolution timed out
     void arpResolutionTimedOut(IArp::Notification *entry);
 
+    // utility: report a push, pop or drop of the queue of a ppp interface to pfrpTable
+    void sampleInterfaceQueue(int pppIndex, simsignal_t signalID, cObject *obj);
+
+    // utility: look up the route of a unicast destination in the route cache, filling it from the routing table on a miss
+    const Ipv4Route *findCachedRoute(const Ipv4Address &destAddr);
+
+    // utility: drop a datagram over its TTL or survivalTime, count it in pfrpTable and send ICMP_TIME_EXCEEDED unless silentDrop
+    void dropExpiredDatagram(Packet *packet, const InterfaceEntry *destIE, int reason);
+
     // utility: verifying CRC
     bool verifyCrc(const Ptr<const Ipv4Header> &ipv4Header);
 
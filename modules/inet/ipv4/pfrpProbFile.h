@@ -0,0 +1,35 @@
+/***
+ * @Date         : 2026-10-19 20:00:00
+ * @FilePath     : RL4Net++/modules/inet/ipv4/pfrpProbFile.h
+ * @Description  : Layout of the sparse binary routing file (.pfrb), an alternative to the dense comma-separated
+ *                 nodeNum x nodeNum text file for large topologies. The file holds a pfrpProbHeader followed by
+ *                 entryNum pfrpProbEntry, one per nonzero entry of the routing matrix, in both directions of
+ *                 every link and sorted by (src, dst). All fields are little-endian. The file is written by
+ *                 utils/prob_to_bin.py and memory-mapped by pfrpTable, so loading it takes O(E).
+ */
+
+#ifndef __PFRP_PROB_FILE_H
+#define __PFRP_PROB_FILE_H
+
+#include <cstdint>
+
+struct pfrpProbHeader
+{
+  char magic[4];     // "PFRB"
+  uint32_t version;  // 1
+  uint32_t nodeNum;  // number of nodes of the topology
+  uint32_t entryNum; // number of entries following the header
+  uint32_t reserved[4];
+};
+
+struct pfrpProbEntry
+{
+  int32_t src;  // row of the entry, the router
+  int32_t dst;  // column of the entry, a neighbor of the router
+  int32_t prob; // forwarding weight, positive
+};
+
+static_assert(sizeof(pfrpProbHeader) == 32, "pfrpProbHeader must stay 32 bytes");
+static_assert(sizeof(pfrpProbEntry) == 12, "pfrpProbEntry must stay 12 bytes");
+
+#endif // __PFRP_PROB_FILE_H
@@ -0,0 +1,220 @@
+/*
+ * @Date         : 2026-10-19 14:00:00
+ * @FilePath     : RL4Net++/modules/inet/ipv4/pfrpRecorder.cc
+ * @Description  : Per-step transition recorder writing columnar chunks from a background thread.
+ */
+#include "pfrpRecorder.h"
+#include <cstring>
+#include <omnetpp.h>
+
+using omnetpp::cRuntimeError;
+
+/**
+ * @description: Get unique static instance of the recorder.
+ *               The instance is destroyed at exit, which writes the partial chunks.
+ * @return {*pfrpRecorder} recorder
+ */
+pfrpRecorder *pfrpRecorder::getInstance()
+{
+    static pfrpRecorder instance;
+    return &instance;
+}
+
+pfrpRecorder::~pfrpRecorder()
+{
+    close();
+}
+
+/**
+ * @description: Open the data and index files and start the writer thread.
+ *               Only the first call takes effect, every application instance passes the same parameters.
+ * @param {char} *prefix    path of the files without extension, empty to disable recording
+ * @param {int} nodeNum     number of nodes of the topology
+ * @param {int} simMode     simMode of the run
+ * @param {int} rows        number of steps per chunk
+ * @return {*} None
+ */
+void pfrpRecorder::open(const char *prefix, int nodeNum, int simMode, int rows)
+{
+    if (opened || !prefix || !prefix[0])
+    {
+        return;
+    }
+    if (rows <= 0)
+    {
+        throw cRuntimeError("pfrpRecorder: chunk size must be positive, got %d", rows);
+    }
+    string base = prefix;
+    dataOut = fopen((base + ".pfrd").c_str(), "wb");
+    indexOut = fopen((base + ".pfri").c_str(), "wb");
+    if (!dataOut || !indexOut)
+    {
+        throw cRuntimeError("pfrpRecorder: cannot open %s.pfrd/.pfri", prefix);
+    }
+
+    pfrpRecordHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, "PFRI", 4);
+    header.version = 1;
+    header.nodeNum = nodeNum;
+    header.simMode = simMode;
+    header.chunkRows = rows;
+    fwrite(&header, sizeof(header), 1, indexOut);
+    fflush(indexOut);
+
+    chunkRows = rows;
+    this->simMode = simMode;
+    dataOffset = 0;
+    stopping = false;
+    opened = true;
+    writer = thread(&pfrpRecorder::writerLoop, this);
+}
+
+/**
+ * @description: Append a row of a stream. The width of a stream is fixed by its first row.
+ * @param {int} stream          see Stream
+ * @param {int} step            step of the row
+ * @param {void} *values        width values of the value type of the stream
+ * @param {int} width           number of values
+ * @return {*} None
+ */
+void pfrpRecorder::record(int stream, int step, const void *values, int width)
+{
+    if (!opened)
+    {
+        return;
+    }
+    Chunk *chunk = staging[stream];
+    if (!chunk)
+    {
+        chunk = new Chunk;
+        chunk->stream = stream;
+        chunk->width = width;
+        chunk->steps.reserve(chunkRows);
+        chunk->rows.reserve(chunkRows * width * valueSize(stream));
+        staging[stream] = chunk;
+    }
+    else if (chunk->width != uint32_t(width))
+    {
+        throw cRuntimeError("pfrpRecorder: stream %d changed width from %u to %d at step %d", stream, chunk->width, width, step);
+    }
+
+    size_t rowBytes = width * valueSize(stream);
+    size_t used = chunk->rows.size();
+    chunk->rows.resize(used + rowBytes);
+    memcpy(chunk->rows.data() + used, values, rowBytes);
+    chunk->steps.push_back(step);
+
+    if (chunk->steps.size() == chunkRows)
+    {
+        staging[stream] = NULL;
+        submit(chunk);
+    }
+}
+
+/**
+ * @description: Queue a chunk for the writer thread.
+ * @param {Chunk} *chunk    full or final chunk, owned by the writer thread from now on
+ * @return {*} None
+ */
+void pfrpRecorder::submit(Chunk *chunk)
+{
+    {
+        lock_guard<mutex> lock(pendingMutex);
+        pending.push_back(chunk);
+    }
+    pendingCond.notify_one();
+}
+
+/**
+ * @description: Write the partial chunks, wait for the writer thread and close the files.
+ * @return {*} None
+ */
+void pfrpRecorder::close()
+{
+    if (!opened)
+    {
+        return;
+    }
+    for (int s = 0; s < STREAM_NUM; s++)
+    {
+        if (staging[s])
+        {
+            submit(staging[s]);
+            staging[s] = NULL;
+        }
+    }
+    {
+        lock_guard<mutex> lock(pendingMutex);
+        stopping = true;
+    }
+    pendingCond.notify_one();
+    writer.join();
+    fclose(dataOut);
+    fclose(indexOut);
+    dataOut = NULL;
+    indexOut = NULL;
+    opened = false;
+}
+
+/**
+ * @description: Body of the background writer thread, writes chunks until stopped and nothing is pending.
+ * @return {*} None
+ */
+void pfrpRecorder::writerLoop()
+{
+    while (true)
+    {
+        Chunk *chunk;
+        {
+            unique_lock<mutex> lock(pendingMutex);
+            pendingCond.wait(lock, [this] { return stopping || !pending.empty(); });
+            if (pending.empty())
+            {
+                return;
+            }
+            chunk = pending.front();
+            pending.pop_front();
+        }
+        writeChunk(chunk);
+        delete chunk;
+    }
+}
+
+/**
+ * @description: Transpose a chunk to column-major order, write it to the data file and append its index entry.
+ * @param {Chunk} *chunk    chunk to be written
+ * @return {*} None
+ */
+void pfrpRecorder::writeChunk(Chunk *chunk)
+{
+    uint32_t rows = chunk->steps.size();
+    uint32_t width = chunk->width;
+    size_t size = valueSize(chunk->stream);
+    size_t stepBytes = (rows * sizeof(int32_t) + 7) / 8 * 8;
+
+    vector<char> out(stepBytes + size_t(rows) * width * size, 0);
+    memcpy(out.data(), chunk->steps.data(), rows * sizeof(int32_t));
+    const char *src = chunk->rows.data();
+    char *dst = out.data() + stepBytes;
+    for (uint32_t c = 0; c < width; c++)
+    {
+        for (uint32_t r = 0; r < rows; r++)
+        {
+            memcpy(dst + (size_t(c) * rows + r) * size, src + (size_t(r) * width + c) * size, size);
+        }
+    }
+    fwrite(out.data(), 1, out.size(), dataOut);
+    fflush(dataOut);
+
+    pfrpRecordChunk entry;
+    entry.stream = chunk->stream;
+    entry.rows = rows;
+    entry.width = width;
+    entry.firstStep = rows ? chunk->steps[0] : 0;
+    entry.offset = dataOffset;
+    entry.bytes = out.size();
+    fwrite(&entry, sizeof(entry), 1, indexOut);
+    fflush(indexOut);
+    dataOffset += out.size();
+}
@@ -0,0 +1,124 @@
+/***
+ * @Date         : 2026-10-19 14:00:00
+ * @FilePath     : RL4Net++/modules/inet/ipv4/pfrpRecorder.h
+ * @Description  : Per-step transition recorder of pfrpTable for offline RL and analysis.
+ *                 Rows are staged in memory by the simulation thread and written as columnar chunks by a
+ *                 background thread, so a step costs one copy of its row.
+ *
+ *                 Two append-only files are written, "<prefix>.pfrd" (data) and "<prefix>.pfri" (index).
+ *                 The index starts with a pfrpRecordHeader followed by one pfrpRecordChunk per chunk, both plain
+ *                 fixed-size structs, so the index can be memory-mapped as an array. A chunk of `rows` steps and
+ *                 `width` values per step is stored at `offset` in the data file as
+ *                   int32 step[rows], padded to 8 bytes, then value[width][rows] (column-major)
+ *                 with the value type of the stream: float64 for the state and the reward, int32 for the action,
+ *                 except in simMode 3 where the action is the float64 split weight of every path.
+ *                 Chunks are written in order, their index entry after their data, so a live run can be read
+ *                 up to its last complete chunk.
+ */
+
+#ifndef __PFRP_RECORDER_H
+#define __PFRP_RECORDER_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+// Header of the index file.
+struct pfrpRecordHeader
+{
+  char magic[4];      // "PFRI"
+  uint32_t version;   // 1
+  int32_t nodeNum;    // number of nodes of the topology
+  int32_t simMode;    // simMode of the run
+  uint32_t chunkRows; // maximal number of steps per chunk
+  uint32_t reserved[11];
+};
+
+// Index entry of a chunk.
+struct pfrpRecordChunk
+{
+  uint32_t stream;   // see pfrpRecorder::Stream
+  uint32_t rows;     // number of steps in the chunk
+  uint32_t width;    // number of values per step
+  int32_t firstStep; // step of the first row
+  uint64_t offset;   // byte offset of the chunk in the data file
+  uint64_t bytes;    // byte size of the chunk in the data file
+};
+
+static_assert(sizeof(pfrpRecordHeader) == 64, "pfrpRecordHeader must stay 64 bytes");
+static_assert(sizeof(pfrpRecordChunk) == 32, "pfrpRecordChunk must stay 32 bytes");
+
+class pfrpRecorder
+{
+public:
+  enum Stream
+  {
+    STREAM_STATE = 0, // float64, the traffic matrix of the state message followed by its optional blocks
+    STREAM_ACTION,    // int32, dense routing table after the action of the agent has been installed, float64 pathWeight in simMode 3
+    STREAM_REWARD,    // float64, avgDelay and lossRate, per node in multi-agent DRL
+    STREAM_NUM
+  };
+
+  // Get unique static instance of the recorder.
+  static pfrpRecorder *getInstance();
+
+  // Open "<prefix>.pfrd" and "<prefix>.pfri" and start the writer thread, an empty prefix disables recording.
+  void open(const char *prefix, int nodeNum, int simMode, int chunkRows);
+
+  // Whether rows are recorded.
+  bool isOpen() const { return opened; }
+
+  // Append a row of a stream, values has width elements of the value type of the stream.
+  void record(int stream, int step, const void *values, int width);
+
+  // Write the partial chunks and stop the writer thread.
+  void close();
+
+  ~pfrpRecorder();
+
+private:
+  struct Chunk
+  {
+    uint32_t stream;
+    uint32_t width;
+    vector<int32_t> steps;
+    vector<char> rows; // row-major while staged, transposed by the writer thread
+  };
+
+  pfrpRecorder() {}
+
+  // Queue a chunk for the writer thread.
+  void submit(Chunk *chunk);
+
+  // Body of the background writer thread.
+  void writerLoop();
+
+  // Transpose and write a chunk, then append its index entry.
+  void writeChunk(Chunk *chunk);
+
+  size_t valueSize(int stream) const { return stream == STREAM_ACTION && simMode != 3 ? sizeof(int32_t) : sizeof(double); }
+
+  bool opened = false;
+  int simMode = 0;
+  uint32_t chunkRows = 64;
+  Chunk *staging[STREAM_NUM] = {NULL};
+
+  mutex pendingMutex;
+  condition_variable pendingCond;
+  deque<Chunk *> pending; // chunks handed over to the writer thread, once every chunkRows steps
+  bool stopping = false;
+  thread writer;
+
+  FILE *dataOut = NULL;
+  FILE *indexOut = NULL;
+  uint64_t dataOffset = 0;
+};
+
+#endif // __PFRP_RECORDER_H
@@ -0,0 +1,108 @@
+/*
+ * @Date         : 2026-10-19 15:00:00
+ * @FilePath     : RL4Net++/modules/inet/ipv4/pfrpShm.cc
+ * @Description  : Shared-memory transport between pfrpTable and the python agent.
+ */
+#include "pfrpShm.h"
+#include <cstring>
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <omnetpp.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+using omnetpp::cRuntimeError;
+
+// polls of the reply doorbell before falling back to the futex
+static const int spinCount = 20000;
+
+/**
+ * @description: Map the region /dev/shm/<name> created by python.
+ * @param {string} &name    name of the region, without /dev/shm/
+ * @return {*} None
+ */
+void pfrpShmChannel::open(const string &name)
+{
+    if (header)
+    {
+        return;
+    }
+    string path = "/dev/shm/" + name;
+    int fd = ::open(path.c_str(), O_RDWR);
+    if (fd < 0)
+    {
+        throw cRuntimeError("pfrpShmChannel: cannot open %s, it is created by the python agent", path.c_str());
+    }
+    struct stat st;
+    fstat(fd, &st);
+    if (size_t(st.st_size) < sizeof(pfrpShmHeader))
+    {
+        ::close(fd);
+        throw cRuntimeError("pfrpShmChannel: %s is too small", path.c_str());
+    }
+    void *addr = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (addr == MAP_FAILED)
+    {
+        throw cRuntimeError("pfrpShmChannel: cannot map %s", path.c_str());
+    }
+    pfrpShmHeader *h = (pfrpShmHeader *)addr;
+    if (memcmp(h->magic, "PFSM", 4) != 0 || h->version != 1 ||
+        sizeof(pfrpShmHeader) + 2 * size_t(h->capacity) > size_t(st.st_size))
+    {
+        munmap(addr, st.st_size);
+        throw cRuntimeError("pfrpShmChannel: %s is not a pfrp shared-memory region", path.c_str());
+    }
+    header = h;
+    mapSize = st.st_size;
+    requestBuf = (char *)addr + sizeof(pfrpShmHeader);
+    replyBuf = requestBuf + header->capacity;
+}
+
+/**
+ * @description: Send a request and block until its reply arrives.
+ * @param {char} *data          request
+ * @param {size_t} size         bytes of the request
+ * @param {size_t} &replySize   bytes of the reply
+ * @return {char *}             reply, valid until the next exchange
+ */
+const char *pfrpShmChannel::exchange(const char *data, size_t size, size_t &replySize)
+{
+    if (size > header->capacity)
+    {
+        throw cRuntimeError("pfrpShmChannel: message of %zu bytes exceeds the capacity of %u bytes", size, header->capacity);
+    }
+    memcpy(requestBuf, data, size);
+    header->requestLen = size;
+    uint32_t seq = __atomic_load_n(&header->requestSeq, __ATOMIC_RELAXED) + 1;
+    __atomic_store_n(&header->requestSeq, seq, __ATOMIC_RELEASE);
+    syscall(SYS_futex, &header->requestSeq, FUTEX_WAKE, 1, NULL, NULL, 0);
+
+    struct timespec timeout = {0, 100000000};
+    for (int spin = 0;; spin++)
+    {
+        uint32_t replied = __atomic_load_n(&header->replySeq, __ATOMIC_ACQUIRE);
+        if (replied == seq)
+        {
+            break;
+        }
+        if (spin >= spinCount)
+        {
+            // sleeps only while replySeq is unchanged, the timeout bounds a missed wake
+            syscall(SYS_futex, &header->replySeq, FUTEX_WAIT, replied, &timeout, NULL, 0);
+        }
+    }
+    replySize = header->replyLen;
+    return replyBuf;
+}
+
+pfrpShmChannel::~pfrpShmChannel()
+{
+    if (header)
+    {
+        munmap(header, mapSize);
+    }
+}
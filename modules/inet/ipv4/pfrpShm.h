@@ -0,0 +1,63 @@
+/***
+ * @Date         : 2026-10-19 15:00:00
+ * @FilePath     : RL4Net++/modules/inet/ipv4/pfrpShm.h
+ * @Description  : Shared-memory transport between pfrpTable and the python agent, an alternative to ZMQ over
+ *                 TCP for agents on the same host. The region /dev/shm/<name> is created by python
+ *                 (modules/gym_env/shm_transport.py) and holds a pfrpShmHeader followed by the request buffer
+ *                 and the reply buffer, each of header.capacity bytes. Messages keep the text format of the
+ *                 ZMQ transport.
+ *
+ *                 A request is written to the request buffer, then requestSeq is incremented and python is woken
+ *                 with a futex on requestSeq. Python writes the reply, sets replySeq to the request number and
+ *                 wakes the simulator with a futex on replySeq. Both sides spin briefly before sleeping, so a
+ *                 round trip takes a few microseconds when the agent answers quickly.
+ */
+
+#ifndef __PFRP_SHM_H
+#define __PFRP_SHM_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+using namespace std;
+
+// Header of the shared region, the doorbells are on separate cache lines.
+struct pfrpShmHeader
+{
+  char magic[4];     // "PFSM"
+  uint32_t version;  // 1
+  uint32_t capacity; // bytes of each of the request and reply buffers
+  uint32_t reserved0[13];
+  uint32_t requestSeq; // number of the last request, futex word python sleeps on
+  uint32_t requestLen; // bytes of the last request
+  uint32_t reserved1[14];
+  uint32_t replySeq; // number of the request the last reply answers, futex word the simulator sleeps on
+  uint32_t replyLen; // bytes of the last reply
+  uint32_t reserved2[14];
+};
+
+static_assert(sizeof(pfrpShmHeader) == 192, "pfrpShmHeader must stay 192 bytes");
+
+class pfrpShmChannel
+{
+public:
+  // Map the region /dev/shm/<name> created by python.
+  void open(const string &name);
+
+  // Whether the channel is mapped.
+  bool isOpen() const { return header != NULL; }
+
+  // Send a request and block until its reply arrives, the reply stays valid until the next exchange.
+  const char *exchange(const char *data, size_t size, size_t &replySize);
+
+  ~pfrpShmChannel();
+
+private:
+  pfrpShmHeader *header = NULL;
+  size_t mapSize = 0;
+  char *requestBuf = NULL;
+  char *replyBuf = NULL;
+};
+
+#endif // __PFRP_SHM_H
@@ -8,6 +8,10 @@
  *                 is selected for forwarding based on the probabilistic routing table.
  */
 #include "pfrpTable.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 pfrpTable *pfrpTable::pTable = NULL;
 
@@ -32,6 +36,15 @@ pfrpTable *pfrpTable::getInstance()
     return pTable;
 }
 
+/**
+ * @description: Whether the unique static instance of probabilistic routing table has been initialized.
+ * @return {bool} whether initTable has been called
+ */
+bool pfrpTable::isInitiated()
+{
+    return pTable != NULL;
+}
+
 /**
  * @description: Initialize probabilistic routing table.
  * @param {int} num                 node num in network topology
@@ -64,33 +77,12 @@ void pfrpTable::initiate()
     string connectAddr = "tcp://localhost:" + to_string(zmqPort);
     zmq_connect((void *)zmqSocket, connectAddr.c_str());
 
-    topo = (int **)malloc(nodeNum * sizeof(int *));
-    memset(topo, 0, nodeNum);
-    int *tmp = (int *)malloc(nodeNum * nodeNum * sizeof(int));
-    memset(tmp, 0, nodeNum * nodeNum);
-    for (int i = 0; i < nodeNum; i++)
-    {
-        topo[i] = tmp + nodeNum * i;
-    }
+    // the links and their weights are kept in the CSR adjacency only, so the table takes O(N + E) memory
+    getProb(routingFileName);
 
-    allProb = (int **)malloc(nodeNum * sizeof(int *));
-    memset(allProb, 0, nodeNum * sizeof(int *));
-    tmp = (int *)malloc(nodeNum * nodeNum * sizeof(int));
-    memset(tmp, 0, nodeNum * nodeNum * sizeof(int));
-    for (int i = 0; i < nodeNum; i++)
-    {
-        allProb[i] = tmp + nodeNum * i;
-    }
-    allProb = getProb(routingFileName, allProb);
+    setSeed(0);
 
-    pkct = (int **)malloc(nodeNum * sizeof(int *));
-    memset(pkct, 0, nodeNum * sizeof(int *));
-    tmp = (int *)malloc(nodeNum * nodeNum * sizeof(int));
-    memset(tmp, 0, nodeNum * nodeNum * sizeof(int));
-    for (int i = 0; i < nodeNum; i++)
-    {
-        pkct[i] = tmp + nodeNum * i;
-    }
+    pkct.assign(edgeNum * 2, 0);
 
     stepIsEnd = (bool *)malloc(totalStep * sizeof(bool));
     memset(stepIsEnd, false, totalStep * sizeof(bool));
@@ -116,10 +108,27 @@ void pfrpTable::initiate()
     stDrop = (int *)malloc(totalStep * sizeof(int));
     memset(stDrop, 0, totalStep * sizeof(int));
 
-    for (int i = 0; i < nodeNum; i++)
-        for (int j = i; j < nodeNum; j++)
-            if (topo[i][j] >= 0)
-                edgeNum++;
+    earlyDrop = (int *)malloc(totalStep * sizeof(int));
+    memset(earlyDrop, 0, totalStep * sizeof(int));
+
+    linkDelay.assign(edgeNum * 2, 0.0);
+    linkInvRate.assign(edgeNum * 2, 0.0);
+    linkDrop.assign(DROP_REASON_NUM * edgeNum * 2, 0);
+
+    queueLen = (int *)malloc(edgeNum * 2 * sizeof(int));
+    memset(queueLen, 0, edgeNum * 2 * sizeof(int));
+
+    queueArea = (double *)malloc(edgeNum * 2 * sizeof(double));
+    memset(queueArea, 0, edgeNum * 2 * sizeof(double));
+
+    queueLastTime = (double *)malloc(edgeNum * 2 * sizeof(double));
+    memset(queueLastTime, 0, edgeNum * 2 * sizeof(double));
+
+    queueDelaySum = (double *)malloc(edgeNum * 2 * sizeof(double));
+    memset(queueDelaySum, 0, edgeNum * 2 * sizeof(double));
+
+    queueDelayCount = (int *)malloc(edgeNum * 2 * sizeof(int));
+    memset(queueDelayCount, 0, edgeNum * 2 * sizeof(int));
 
     // multi-agent DRL
     if (simMode == 2)
@@ -164,46 +173,174 @@ int pfrpTable::getNodeNum()
 }
 
 /**
- * @description: Convert the initial probabilistic routing table into a probability matrix.
- * @param {string} fileName     file path to initial probabilistic routing table
- * @param {int} **Prob          initial probabilistic routing matrix
- * @return {**pfrpTable}        updated probabilitstic routing matrix
+ * @description: Read the initial probabilistic routing table into the CSR adjacency and number its links,
+ *               from a sparse binary file if its name ends with .pfrb, else from a dense text file.
+ * @param {string} &fileName    file path to initial probabilistic routing table
+ * @return {*} None
  */
-int **pfrpTable::getProb(string fileName, int **Prob)
+void pfrpTable::getProb(const string &fileName)
 {
-    ifstream myfile(fileName);
+    if (fileName.size() > 5 && fileName.compare(fileName.size() - 5, 5, ".pfrb") == 0)
+    {
+        getProbBinary(fileName);
+    }
+    else
+    {
+        getProbText(fileName);
+    }
+}
 
-    for (int i = 0; i < nodeNum; i++)
+/**
+ * @description: Read a dense comma-separated nodeNum x nodeNum routing file. The file is streamed and only
+ *               its nonzero entries are kept, in row-major order, that is sorted by (src, dst).
+ * @param {string} &fileName    file path to initial probabilistic routing table
+ * @return {*} None
+ */
+void pfrpTable::getProbText(const string &fileName)
+{
+    ifstream myfile(fileName);
+    if (!myfile)
     {
-        for (int j = 0; j < nodeNum; j++)
-        {
-            string od_prob;
-            getline(myfile, od_prob, ',');
-            Prob[i][j] = atoi(od_prob.c_str());
-        }
+        throw cRuntimeError("pfrpTable: cannot open the routing file %s", fileName.c_str());
     }
 
-    int edgeCount = 0;
+    string od_prob;
+    vector<pfrpProbEntry> entries;
     for (int i = 0; i < nodeNum; i++)
     {
-        for (int j = i; j < nodeNum; j++)
+        for (int j = 0; j < nodeNum; j++)
         {
-
-            if (Prob[i][j])
+            if (!getline(myfile, od_prob, ','))
             {
-                topo[i][j] = edgeCount * 2;
-                topo[j][i] = edgeCount * 2 + 1;
-                edgeCount++;
+                throw cRuntimeError("pfrpTable: %s has %lld values, %d x %d expected for nodeNum %d",
+                                    fileName.c_str(), (long long)i * nodeNum + j, nodeNum, nodeNum, nodeNum);
             }
-            else
+            int prob = atoi(od_prob.c_str());
+            if (prob && i == j)
+            {
+                throw cRuntimeError("pfrpTable: %s links R%d to itself", fileName.c_str(), i);
+            }
+            if (prob)
             {
-                topo[i][j] = -1;
-                topo[j][i] = -1;
+                entries.push_back(pfrpProbEntry{i, j, prob});
             }
         }
     }
+    while (getline(myfile, od_prob, ','))
+    {
+        if (od_prob.find_first_not_of(" \t\r\n") != string::npos)
+        {
+            throw cRuntimeError("pfrpTable: %s has more than %d x %d values, nodeNum is %d",
+                                fileName.c_str(), nodeNum, nodeNum, nodeNum);
+        }
+    }
     myfile.close();
-    return Prob;
+    buildAdjacency(entries.data(), entries.size());
+}
+
+/**
+ * @description: Read a sparse binary routing file, see pfrpProbFile.h. The entries are sorted by (src, dst),
+ *               so the links i < j come in the row-major order of the text file.
+ * @param {string} &fileName    file path to initial probabilistic routing table
+ * @return {*} None
+ */
+void pfrpTable::getProbBinary(const string &fileName)
+{
+    int fd = open(fileName.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        throw cRuntimeError("pfrpTable: cannot open the routing file %s", fileName.c_str());
+    }
+    struct stat st;
+    fstat(fd, &st);
+    size_t size = st.st_size;
+    if (size < sizeof(pfrpProbHeader))
+    {
+        close(fd);
+        throw cRuntimeError("pfrpTable: %s is too small for a binary routing file", fileName.c_str());
+    }
+    void *addr = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED)
+    {
+        throw cRuntimeError("pfrpTable: cannot map %s", fileName.c_str());
+    }
+
+    const pfrpProbHeader *header = (const pfrpProbHeader *)addr;
+    const pfrpProbEntry *entries = (const pfrpProbEntry *)(header + 1);
+    string error;
+    char buf[200];
+    if (memcmp(header->magic, "PFRB", 4) != 0 || header->version != 1)
+    {
+        error = "is not a binary routing file";
+    }
+    else if (header->nodeNum != uint32_t(nodeNum))
+    {
+        snprintf(buf, sizeof(buf), "has %u nodes, nodeNum is %d", header->nodeNum, nodeNum);
+        error = buf;
+    }
+    else if (sizeof(pfrpProbHeader) + size_t(header->entryNum) * sizeof(pfrpProbEntry) != size)
+    {
+        snprintf(buf, sizeof(buf), "has %zu bytes, %u entries expected", size, header->entryNum);
+        error = buf;
+    }
+
+    int64_t prevKey = -1;
+    for (uint32_t k = 0; error.empty() && k < header->entryNum; k++)
+    {
+        const pfrpProbEntry &e = entries[k];
+        int64_t key = int64_t(e.src) * nodeNum + e.dst;
+        if (e.src < 0 || e.src >= nodeNum || e.dst < 0 || e.dst >= nodeNum || e.src == e.dst || e.prob <= 0)
+        {
+            snprintf(buf, sizeof(buf), "has an invalid entry %d,%d,%d", e.src, e.dst, e.prob);
+            error = buf;
+        }
+        else if (key <= prevKey)
+        {
+            snprintf(buf, sizeof(buf), "is not sorted by (src, dst) at entry %u", k);
+            error = buf;
+        }
+        else
+        {
+            prevKey = key;
+        }
+    }
+    if (!error.empty())
+    {
+        munmap(addr, size);
+        throw cRuntimeError("pfrpTable: %s %s", fileName.c_str(), error.c_str());
+    }
+    try
+    {
+        buildAdjacency(entries, header->entryNum);
+    }
+    catch (...)
+    {
+        munmap(addr, size);
+        throw;
+    }
+    munmap(addr, size);
+}
+
+/**
+ * @description: Check that a router has as many point-to-point links in the network as neighbors in the
+ *               routing file, since the k-th ppp interface must lead to the k-th neighbor.
+ * @param {int} nodeId      ID of the router
+ * @param {int} linkNum     number of pppg gates of the router
+ * @return {*} None
+ */
+void pfrpTable::checkDegree(int nodeId, int linkNum)
+{
+    if (nodeId >= nodeNum)
+    {
+        throw cRuntimeError("pfrpTable: R%d is not in the routing file %s of %d nodes", nodeId, routingFileName.c_str(), nodeNum);
+    }
+    int degree = adjStart[nodeId + 1] - adjStart[nodeId];
+    if (linkNum != degree)
+    {
+        throw cRuntimeError("pfrpTable: R%d has %d point-to-point links in the network but %d neighbors in %s",
+                            nodeId, linkNum, degree, routingFileName.c_str());
+    }
 }
 
 /***
@@ -214,36 +351,52 @@ int **pfrpTable::getProb(string fileName, int **Prob)
  */
 int pfrpTable::getNextNode(int nodeId, int dstNode)
 {
-    if (allProb[nodeId][dstNode])
+    if (findLink(nodeId, dstNode) >= 0)
     {
         return dstNode;
     }
-    else
+    if (loopFree)
     {
-        vector<int> candidateNodes;
-        vector<int> candidateProbs;
-        int probSum = 0;
-        for (int i = 0; i < nodeNum; i++)
+        int closer = sampleCloser(nodeId, dstNode);
+        if (closer >= 0)
         {
-            // if the point with id i is adjacent to the current point and up to the dstnode node
-            if (allProb[nodeId][i])
-            {
-                candidateNodes.push_back(i);
-                candidateProbs.push_back(allProb[nodeId][i]);
-                probSum += allProb[nodeId][i];
-            }
+            return closer;
         }
-        int randProb = int(rand() % probSum);
+    }
+    int begin = adjStart[nodeId];
+    int last = adjStart[nodeId + 1] - 1;
+    if (probResolution == 16)
+    {
+        uint16_t draw = routerRng[nodeId].next() >> 16;
+        for (int k = begin; k < last; k++)
+            if (draw <= probThreshold16[k])
+                return adjNode[k];
+        return adjNode[last];
+    }
+    if (probResolution == 32)
+    {
+        uint32_t draw = routerRng[nodeId].next();
+        for (int k = begin; k < last; k++)
+            if (draw <= probThreshold32[k])
+                return adjNode[k];
+        return adjNode[last];
+    }
 
-        for (int i = 0; i < candidateNodes.size(); i++)
-        {
-            int curProb = 0;
-            for (int j = 0; j <= i; j++)
-                curProb += candidateProbs[j];
-            if (randProb <= curProb)
-                return candidateNodes[i];
-        }
+    int probSum = 0;
+    for (int k = begin; k <= last; k++)
+    {
+        probSum += adjProb[k];
+    }
+    int randProb = int(routerRng[nodeId].below(probSum));
+
+    int curProb = 0;
+    for (int k = begin; k < last; k++)
+    {
+        curProb += adjProb[k];
+        if (randProb < curProb)
+            return adjNode[k];
     }
+    return adjNode[last];
 }
 
 /**
@@ -255,24 +408,28 @@ int pfrpTable::getNextNode(int nodeId, int dstNode)
 int pfrpTable::getGateId(int nodeId, int nextNode)
 {
 
-    int gateId = 0;
-
-    // links in the environment are bi-directional links
-    for (int i = 0; i < nodeNum; i++)
-    {
-        if (allProb[nodeId][i])
-        {
-            if (i == nextNode)
-                break;
-            else
-                gateId++;
-        }
-    }
+    // links in the environment are bi-directional links,
+    // point-to-point interfaces follow the neighbors in ascending ID order
+    auto begin = adjNode.begin() + adjStart[nodeId];
+    int gateId = int(lower_bound(begin, adjNode.begin() + adjStart[nodeId + 1], nextNode) - begin);
     // The first bit of ift has a lo0, so +1.
     gateId++;
     return gateId;
 }
 
+/**
+ * @description: Find the link from a router to a neighbor by binary search of its CSR row.
+ * @param {int} nodeId      ID of the router
+ * @param {int} neighbor    ID of the other end
+ * @return {int}            position of the link in adjNode, -1 if the routers are not neighbors
+ */
+int pfrpTable::findLink(int nodeId, int neighbor) const
+{
+    auto end = adjNode.begin() + adjStart[nodeId + 1];
+    auto it = lower_bound(adjNode.begin() + adjStart[nodeId], end, neighbor);
+    return (it != end && *it == neighbor) ? int(it - adjNode.begin()) : -1;
+}
+
 /**
  * @description: Get next hop and the ID of the output gate forwarded by the current node to the next node.
  * @param {string} path         routing path
@@ -293,7 +450,7 @@ pair<string, int> pfrpTable::getRoute(string path, const char *pkName, int pkByt
     char *locPtr = NULL;
     char *networkName = strtok_r(pathCpy, ".", &locPtr);
     char *thisNodeName = strtok_r(NULL, ".", &locPtr);
-    int thisNodeId = atoi(thisNodeName + 1);
+    int thisNodeId = parseNodeId(thisNodeName);
 
     // a pkName example: H0-H5-pfrp-4387-0
     char pkNameCpy[50] = {0};
@@ -308,7 +465,7 @@ pair<string, int> pfrpTable::getRoute(string path, const char *pkName, int pkByt
     if (thisNodeName[0] == 'H')
     {
         // first hop: from host to router
-        p.first = "R" + to_string(thisNodeId);
+        p.first = nodeName('R', thisNodeId);
         p.second = 1;
         return p;
     }
@@ -316,15 +473,9 @@ pair<string, int> pfrpTable::getRoute(string path, const char *pkName, int pkByt
     if (thisNodeId == dstNodeId)
     {
         // final hop: from router to host
-        p.first = "H" + to_string(dstNodeId);
-        int gid = 0;
-        for (int i = 0; i < nodeNum; i++)
-        {
-            if (allProb[dstNodeId][i])
-            {
-                gid++;
-            }
-        }
+        p.first = nodeName('H', dstNodeId);
+        // the host interface follows the point-to-point interfaces of all neighbors, whatever their weights
+        int gid = adjStart[dstNodeId + 1] - adjStart[dstNodeId];
         // Ift has a lo0 in the first place so it should be +1,
         // router pointing to host is the last interface so it should be +1 again
         // counting from 0 so it should be -1
@@ -332,47 +483,75 @@ pair<string, int> pfrpTable::getRoute(string path, const char *pkName, int pkByt
         return p;
     }
 
-    int nextNode = getNextNode(thisNodeId, dstNodeId);
-    p.first = "R" + to_string(nextNode);
-    p.second = getGateId(thisNodeId, nextNode);
-    countPkct(thisNodeId, nextNode, pkByte);
+    PFRP_TIMING_BEGIN(PHASE_FORWARD);
+    int nextNode;
+    if (simMode == 3)
+    {
+        // source routing, a pkName example: H0-H5-pfrpkp-4387-0-2, the last field is the path index
+        strtok_r(NULL, "-", &locPtr_1);
+        strtok_r(NULL, "-", &locPtr_1);
+        strtok_r(NULL, "-", &locPtr_1);
+        char *pathName = strtok_r(NULL, "-", &locPtr_1);
+        nextNode = getPathNextNode(thisNodeId, atoi(srcName + 1), dstNodeId, pathName ? atoi(pathName) : 0);
+    }
+    else if (simMode == 4)
+    {
+        nextNode = getEcmpNextNode(thisNodeId, atoi(srcName + 1), dstNodeId);
+    }
+    else if (flowletGap > 0)
+    {
+        nextNode = getFlowletNextNode(thisNodeId, atoi(srcName + 1), dstNodeId);
+    }
+    else
+    {
+        nextNode = getNextNode(thisNodeId, dstNodeId);
+    }
+    if (detourStats)
+    {
+        const uint16_t *dist = getHopDist(dstNodeId);
+        routedHops++;
+        if (dist[nextNode] >= dist[thisNodeId])
+        {
+            nonProgressHops++;
+        }
+    }
+    // one lookup of the link gives both the interface and the traffic counter
+    int pos = findLink(thisNodeId, nextNode);
+    p.first = nodeName('R', nextNode);
+    p.second = pos - adjStart[thisNodeId] + 1;
+    pkct[adjEdge[pos]] += pkByte;
+    PFRP_TIMING_END(PHASE_FORWARD);
 
     return p;
 }
 
 /**
- * @description: show the details of routing table and network topology
+ * @description: Record the routing table and network topology of a step. The matrices are queued as binary
+ *               snapshots on the sampled steps only, the scalar details as a debug line.
+ * @param {int} step    the step whose routing table has just been installed
  * @return {*} None
  */
-void pfrpTable::showInfo()
+void pfrpTable::showInfo(int step)
 {
-    cout << endl;
-    cout << "allProb:" << endl;
-    for (int ii = 0; ii < nodeNum; ii++)
+    PFRP_TIMING_BEGIN(PHASE_SHOW_INFO);
+    pfrpTelemetry *telemetry = pfrpTelemetry::getInstance();
+    if (telemetry->isSnapshotStep(step))
     {
-        for (int jj = 0; jj < nodeNum; jj++)
+        if (!topoSnapshotTaken)
         {
-            cout << allProb[ii][jj] << " ";
+            // the topology does not change during a run, -1 marks node pairs without a link
+            expandRows(adjEdge, -1, denseRow);
+            telemetry->snapshot(step, pfrpTelemetry::SNAPSHOT_TOPO, denseRow.data(), nodeNum);
+            topoSnapshotTaken = true;
         }
-        cout << endl;
+        expandRows(adjProb, 0, denseRow);
+        telemetry->snapshot(step, pfrpTelemetry::SNAPSHOT_ALLPROB, denseRow.data(), nodeNum);
     }
-
-    cout << endl;
-    cout << "topo:" << endl;
-    for (int ii = 0; ii < nodeNum; ii++)
+    if (telemetry->isEnabled(pfrpTelemetry::LEVEL_DEBUG))
     {
-        for (int jj = 0; jj < nodeNum; jj++)
-        {
-            cout << topo[ii][jj] << " ";
-        }
-        cout << endl;
+        telemetry->log(pfrpTelemetry::LEVEL_DEBUG, "step " + to_string(step) + "  edgeNum: " + to_string(edgeNum) + "  totalStep: " + to_string(totalStep));
     }
-
-    cout << endl;
-    cout << "edgeNum:  " << edgeNum << endl;
-    cout << endl;
-    cout << "totalStep:  " << totalStep << endl;
-    cout << endl;
+    PFRP_TIMING_END(PHASE_SHOW_INFO);
 }
 
 /**
@@ -396,7 +575,11 @@ void pfrpTable::setRoutingFileName(const char *file)
  */
 void pfrpTable::countPkct(int src, int dst, int pkByte)
 {
-    pkct[src][dst] += pkByte;
+    int pos = findLink(src, dst);
+    if (pos >= 0)
+    {
+        pkct[adjEdge[pos]] += pkByte;
+    }
 }
 
 /**
@@ -421,12 +604,27 @@ void pfrpTable::setVals(int port, double survivalTime_v, int totalStep_v, int si
  */
 void pfrpTable::cleanPkctAndTps()
 {
+    fill(pkct.begin(), pkct.end(), 0);
+}
 
+/**
+ * @description: Expand values aligned with adjNode into a dense row-major nodeNum x nodeNum matrix,
+ *               for the message and file formats that carry whole matrices.
+ * @param {vector<int>} &values     one value per link, aligned with adjNode
+ * @param {int} fillValue           value of the node pairs without a link
+ * @param {vector<int>} &dense      the matrix
+ * @return {*} None
+ */
+void pfrpTable::expandRows(const vector<int> &values, int fillValue, vector<int> &dense) const
+{
+    dense.assign(size_t(nodeNum) * nodeNum, fillValue);
     for (int i = 0; i < nodeNum; i++)
-        for (int j = 0; j < nodeNum; j++)
+    {
+        for (int k = adjStart[i]; k < adjStart[i + 1]; k++)
         {
-            pkct[i][j] = 0;
+            dense[size_t(i) * nodeNum + adjNode[k]] = values[k];
         }
+    }
 }
 
 /**
@@ -491,37 +689,110 @@ void pfrpTable::updateProb(int step)
     if (updateProbCount[step] == nodeNum)
     {
         // the last node to go into next update step
+        if (simMode == 2 && agentGroups > 0)
+        {
+            // every router exchanges its own observation and row with the agent of its group
+            exchangeGroups(step);
+            sendId = 0; // reset packer ID at the start of next step
+            tableVersion++;
+            showInfo(step);
+            return;
+        }
+        PFRP_TIMING_BEGIN(PHASE_STATE);
+        bool recording = pfrpRecorder::getInstance()->isOpen();
+        recordRow.clear();
         string stateStr;
         stateStr += "s@@" + to_string(step) + "@@";
         for (int i = 0; i < nodeNum; i++)
-            for (int j = 0; j < nodeNum; j++)
+            for (int j = 0, k = adjStart[i]; j < nodeNum; j++)
             {
+                // the state is the dense traffic matrix, the links of row i come in ascending j
+                int bytes = (k < adjStart[i + 1] && adjNode[k] == j) ? pkct[adjEdge[k++]] : 0;
+                double traffic = double(bytes) / 1024 / 1024;
+                if (recording)
+                    recordRow.push_back(traffic);
                 if (i == nodeNum - 1 && j == nodeNum - 1)
-                    stateStr += to_string(double(pkct[i][j]) / 1024 / 1024);
+                    stateStr += to_string(traffic);
                 else
-                    stateStr += to_string(double(pkct[i][j]) / 1024 / 1024) + ",";
+                    stateStr += to_string(traffic) + ",";
             }
         cleanPkctAndTps();
 
-        const char *reqData = stateStr.c_str();
-        const size_t reqLen = strlen(reqData);
-        zmq::message_t request{reqLen};
-        memcpy(request.data(), reqData, reqLen);
-        zmqSocket.send(request);
+        if (queueState)
+        {
+            // optional blocks aligned with the topo edge ids:
+            // time-weighted average queue length and average queueing delay over the step
+            closeQueueInterval(stepEndTime[step]);
+            string lenStr = "@@qlen=";
+            string delayStr = "@@qdelay=";
+            for (int e = 0; e < edgeNum * 2; e++)
+            {
+                lenStr += to_string(queueAvgLen[e]) + (e == edgeNum * 2 - 1 ? "" : ",");
+                delayStr += to_string(queueAvgDelay[e]) + (e == edgeNum * 2 - 1 ? "" : ",");
+            }
+            stateStr += lenStr + delayStr;
+            if (recording)
+            {
+                // same order as the message: every qlen, then every qdelay
+                recordRow.insert(recordRow.end(), queueAvgLen.begin(), queueAvgLen.end());
+                recordRow.insert(recordRow.end(), queueAvgDelay.begin(), queueAvgDelay.end());
+            }
+        }
+        if (detourStats)
+        {
+            // router-to-router hops of the step that did not get closer to the destination, and all of them
+            stateStr += "@@detour=" + to_string(nonProgressOfStep[step]) + "," + to_string(routedOfStep[step]);
+            if (recording)
+            {
+                recordRow.push_back(nonProgressOfStep[step]);
+                recordRow.push_back(routedOfStep[step]);
+            }
+        }
+        if (recording)
+        {
+            pfrpRecorder::getInstance()->record(pfrpRecorder::STREAM_STATE, step, recordRow.data(), recordRow.size());
+        }
+
+        PFRP_TIMING_END(PHASE_STATE);
 
-        zmq::message_t reply;
-        zmqSocket.recv(&reply);
-        char *buffer = new char[reply.size() + 1];
-        memset(buffer, 0, reply.size() + 1);
-        memcpy(buffer, reply.data(), reply.size());
+        size_t replySize;
+        const char *reply = exchange(stateStr, replySize);
+
+        PFRP_TIMING_BEGIN(PHASE_STATE);
+        char *buffer = new char[replySize + 1];
+        memset(buffer, 0, replySize + 1);
+        memcpy(buffer, reply, replySize);
 
         // single-agent DRL
-        if (simMode == 1)
+        if (strncmp(buffer, "d@@", 3) == 0)
+        {
+            // sparse update, only the rows it touches are renormalized
+            if (simMode == 3)
+                applyPathDelta(buffer + 3);
+            else
+                applyDelta(buffer + 3);
+        }
+        else if (simMode == 3)
+        {
+            // split weights of every path, in the order of the path ids
+            char *next = buffer;
+            for (size_t p = 0; p < pathWeight.size(); p++)
+            {
+                char *value = next;
+                pathWeight[p] = strtod(value, &next);
+                if (next == value)
+                {
+                    throw cRuntimeError("pfrpTable: the action has %zu path weights, %zu expected", p, pathWeight.size());
+                }
+                if (*next == ',')
+                    next++;
+            }
+        }
+        else if (simMode == 1)
         {
             // Update for single-agent DRL
             // Get the link weights for twice the number of network links and assemble them into a probability matrix on the omnetpp side.
             char *od_prob;
-            double *weights = new double[edgeNum * 2];
             for (int i = 0; i < edgeNum * 2; i++)
             {
                 if (i == 0)
@@ -532,38 +803,19 @@ void pfrpTable::updateProb(int step)
                 {
                     od_prob = strtok(NULL, ",");
                 }
-                weights[i] = atof(od_prob);
+                adjWeight[edgePos[i]] = atof(od_prob);
             }
 
             for (int i = 0; i < nodeNum; i++)
             {
-                double totalWeight = 0.0;
-                for (int j = 0; j < nodeNum; j++)
-                {
-                    if (topo[i][j] >= 0)
-                    {
-                        totalWeight += weights[topo[i][j]];
-                    }
-                }
-                for (int j = 0; j < nodeNum; j++)
-                {
-                    if (topo[i][j] >= 0)
-                    {
-                        int prob = (int)(weights[topo[i][j]] / totalWeight * 100);
-                        if (prob < 1)
-                        {
-                            prob = 1;
-                        }
-                        allProb[i][j] = prob;
-                    }
-                }
+                normalizeRow(i);
             }
-            delete weights;
         }
         // multi-agent
         else if (simMode == 2)
         {
-            // The probability matrix is calculated on the python side and passed directly to the receiver.
+            // The probability matrix is calculated on the python side and passed directly to the receiver,
+            // only the entries of the neighbors are kept.
             char *newProb;
             for (int i = 0; i < nodeNum; i++)
             {
@@ -577,13 +829,30 @@ void pfrpTable::updateProb(int step)
                     {
                         newProb = strtok(NULL, ",");
                     }
-                    allProb[i][j] = atoi(newProb);
+                    rowValue[j] = atof(newProb);
                 }
+                installValues(i);
             }
         }
         sendId = 0; // reset packer ID at the start of next step
-        showInfo();
         delete buffer;
+        if (recording)
+        {
+            if (simMode == 3)
+            {
+                // the agent sets the split weights of the paths, adjProb is not used
+                pfrpRecorder::getInstance()->record(pfrpRecorder::STREAM_ACTION, step, pathWeight.data(), pathWeight.size());
+            }
+            else
+            {
+                // the action is recorded as the dense table the agent sees
+                expandRows(adjProb, 0, denseRow);
+                pfrpRecorder::getInstance()->record(pfrpRecorder::STREAM_ACTION, step, denseRow.data(), denseRow.size());
+            }
+        }
+        PFRP_TIMING_END(PHASE_STATE);
+        tableVersion++;
+        showInfo(step);
     }
 }
 
@@ -613,6 +882,7 @@ void pfrpTable::endStep(int step)
     }
     else
     {
+        PFRP_TIMING_BEGIN(PHASE_REWARD);
         double sum = 0.0;
         for (int i = 0; i < delayWithStep[step].size(); i++)
         {
@@ -622,18 +892,22 @@ void pfrpTable::endStep(int step)
 
         double lossRate = 1.0 - (double)(delayWithStep[step].size()) / (double)(pkNumOfStep[step]);
         string reward = to_string(avgDelay) + "," + to_string(lossRate);
+        if (pfrpRecorder::getInstance()->isOpen())
+        {
+            double rewardRow[2] = {avgDelay, lossRate};
+            pfrpRecorder::getInstance()->record(pfrpRecorder::STREAM_REWARD, step, rewardRow, 2);
+        }
         string reqStr = "r@@" + to_string(step) + "@@" + reward;
+        if (dropStats)
+        {
+            appendDropBlocks(reqStr, step);
+        }
 
-        cout << "---- reward ---- " << reqStr << endl;
-
-        const char *reqData = reqStr.c_str();
-        const size_t reqLen = strlen(reqData);
-        zmq::message_t request{reqLen};
-        memcpy(request.data(), reqData, reqLen);
-        zmqSocket.send(request);
+        pfrpTelemetry::getInstance()->log(pfrpTelemetry::LEVEL_INFO, "---- reward ---- " + reqStr);
+        PFRP_TIMING_END(PHASE_REWARD);
 
-        zmq::message_t reply;
-        zmqSocket.recv(&reply);
+        size_t replySize;
+        exchange(reqStr, replySize);
     }
     stepFinished[step] = true;
 }
@@ -657,6 +931,27 @@ void pfrpTable::stepEndRecord(int step, double endTime)
     {
         stepIsEnd[step] = true;
         stepEndTime[step] = endTime;
+        if (detourStats)
+        {
+            nonProgressOfStep[step] = nonProgressHops;
+            routedOfStep[step] = routedHops;
+            pfrpTelemetry::getInstance()->log(pfrpTelemetry::LEVEL_INFO, "---- detour ---- step " + to_string(step) + ": " +
+                                                                             to_string(nonProgressHops) + " of " +
+                                                                             to_string(routedHops) + " hops without progress");
+            nonProgressHops = 0;
+            routedHops = 0;
+        }
+        if (flowletGap > 0)
+        {
+            pfrpTelemetry::getInstance()->log(pfrpTelemetry::LEVEL_INFO, "---- flowlet ---- step " + to_string(step) + ": " +
+                                                                             to_string(flowletHits) + " of " +
+                                                                             to_string(flowletLookups) + " next hops from the cache");
+            flowletHits = 0;
+            flowletLookups = 0;
+        }
+#ifdef PFRP_TIMING
+        writeTimingRecord(step, endTime);
+#endif
     }
 }
 
@@ -680,7 +975,7 @@ void pfrpTable::countPktInNode(string path, const char *pkName)
         return;
     }
 
-    int thisNodeId = atoi(thisNodeName + 1);
+    int thisNodeId = parseNodeId(thisNodeName);
 
     // an example of pkName: H0-H5-pfrp-4387-0
     char pkNameCpy[50] = {0};
@@ -750,6 +1045,7 @@ void pfrpTable::endStepMulti(int step)
     }
     else
     {
+        PFRP_TIMING_BEGIN(PHASE_REWARD);
         vector<int> pktPass(nodeNum, 0);
         vector<int> pktArrive(nodeNum, 0);
         vector<vector<double>> delays;
@@ -769,7 +1065,15 @@ void pfrpTable::endStepMulti(int step)
             delays.push_back(nvec);
         }
 
+        // the drop blocks cover the whole network, every group gets them with the reward of each of its routers
+        string dropStr;
+        if (dropStats)
+        {
+            appendDropBlocks(dropStr, step);
+        }
+
         string reqStr = "r@@" + to_string(step) + "@@";
+        recordRow.clear();
         for (int i = 0; i < nodeNum; i++)
         {
             double sum = 0.0;
@@ -782,30 +1086,36 @@ void pfrpTable::endStepMulti(int step)
             double lossRate = 1.0 - (double)(pktArrive[i]) / (double)(pktPass[i]);
 
             reqStr += to_string(avgDelay) + "," + to_string(lossRate) + "/";
+            if (agentGroups > 0)
+            {
+                // the reward of a router goes to the agent of its group
+                sendToGroup(i, "r@@" + to_string(step) + "@@" + to_string(i) + "@@" + to_string(avgDelay) + "," + to_string(lossRate) + dropStr);
+            }
+            recordRow.push_back(avgDelay);
+            recordRow.push_back(lossRate);
         }
         reqStr.pop_back(); // remove final '/'
+        reqStr += dropStr;
+        pfrpRecorder::getInstance()->record(pfrpRecorder::STREAM_REWARD, step, recordRow.data(), recordRow.size());
 
-        cout << endl;
-        cout << " -------- reward -------- " << endl;
-        cout << endl
-             << endl
-             << reqStr << endl
-             << endl;
+        pfrpTelemetry::getInstance()->log(pfrpTelemetry::LEVEL_INFO, " -------- reward -------- " + reqStr);
 
         for (int i = 0; i < nodeNum; i++)
         {
             pktInNode[step][i]->clear();
         }
         pktDelay[step]->clear();
+        PFRP_TIMING_END(PHASE_REWARD);
 
-        const char *reqData = reqStr.c_str();
-        const size_t reqLen = strlen(reqData);
-        zmq::message_t request{reqLen};
-        memcpy(request.data(), reqData, reqLen);
-        zmqSocket.send(request);
-
-        zmq::message_t reply;
-        zmqSocket.recv(&reply);
+        if (agentGroups > 0)
+        {
+            gatherGroupReplies(false);
+        }
+        else
+        {
+            size_t replySize;
+            exchange(reqStr, replySize);
+        }
     }
     stepFinished[step] = true;
 }
@@ -818,3 +1128,1662 @@ int pfrpTable::getSendId()
 {
     return sendId++;
 }
+
+/**
+ * @description: Get the topo edge id of the link behind the gateIndex-th point-to-point interface of a router.
+ *               Point-to-point interfaces are connected in ascending order of the neighbor ID, the order of
+ *               the CSR adjacency, so the lookup is O(1) on every queue event.
+ * @param {int} nodeId      ID of the router, -1 for a host
+ * @param {int} gateIndex   index of the point-to-point interface, counting from 0
+ * @return {int}            topo edge id, -1 if there is no such interface
+ */
+int pfrpTable::getEdgeId(int nodeId, int gateIndex)
+{
+    if (nodeId < 0 || nodeId >= nodeNum || gateIndex < 0 || gateIndex >= adjStart[nodeId + 1] - adjStart[nodeId])
+    {
+        return -1;
+    }
+    return adjEdge[adjStart[nodeId] + gateIndex];
+}
+
+/**
+ * @description: Build the CSR adjacency of the topology from the nonzero entries of the routing table and
+ *               number its links in O(E): the link i < j gets the topo edge id 2k for i -> j and 2k + 1 for
+ *               j -> i, k counting the links in the row-major order of the table.
+ * @param {pfrpProbEntry} *entries  entries of the routing table, sorted by (src, dst)
+ * @param {size_t} entryNum         number of entries
+ * @return {*} None
+ */
+void pfrpTable::buildAdjacency(const pfrpProbEntry *entries, size_t entryNum)
+{
+    adjStart.assign(nodeNum + 1, 0);
+    for (size_t k = 0; k < entryNum; k++)
+    {
+        adjStart[entries[k].src + 1]++;
+    }
+    partial_sum(adjStart.begin(), adjStart.end(), adjStart.begin());
+    // sorted by (src, dst), so every row is in ascending ID order
+    adjNode.resize(entryNum);
+    adjProb.resize(entryNum);
+    adjWeight.resize(entryNum);
+    for (size_t k = 0; k < entryNum; k++)
+    {
+        adjNode[k] = entries[k].dst;
+        adjProb[k] = entries[k].prob;
+        // the initial table gives the initial weights
+        adjWeight[k] = entries[k].prob;
+    }
+
+    edgeEnds.clear();
+    adjEdge.assign(entryNum, -1);
+    for (int i = 0; i < nodeNum; i++)
+    {
+        for (int pos = adjStart[i]; pos < adjStart[i + 1]; pos++)
+        {
+            int j = adjNode[pos];
+            if (j < i)
+            {
+                continue;
+            }
+            int back = findLink(j, i);
+            if (adjProb[pos] <= 0 || back < 0 || adjProb[back] <= 0)
+            {
+                throw cRuntimeError("pfrpTable: %s gives R%d -> R%d weight %d but R%d -> R%d weight %d, links are bi-directional",
+                                    routingFileName.c_str(), i, j, adjProb[pos], j, i, back < 0 ? 0 : adjProb[back]);
+            }
+            adjEdge[pos] = edgeEnds.size() * 2;
+            adjEdge[back] = edgeEnds.size() * 2 + 1;
+            edgeEnds.push_back(make_pair(i, j));
+        }
+    }
+    edgeNum = edgeEnds.size();
+    // every link has been checked in both directions, so further entries are one-way
+    if (size_t(edgeNum) * 2 != entryNum)
+    {
+        throw cRuntimeError("pfrpTable: %s has entries without the reverse direction", routingFileName.c_str());
+    }
+    edgePos.assign(edgeNum * 2, 0);
+    edgeSrc.assign(edgeNum * 2, 0);
+    for (int i = 0; i < nodeNum; i++)
+    {
+        for (int pos = adjStart[i]; pos < adjStart[i + 1]; pos++)
+        {
+            edgePos[adjEdge[pos]] = pos;
+            edgeSrc[adjEdge[pos]] = i;
+        }
+    }
+
+    int maxDegree = 0;
+    for (int i = 0; i < nodeNum; i++)
+    {
+        maxDegree = max(maxDegree, adjStart[i + 1] - adjStart[i]);
+    }
+    rowWidth.assign(maxDegree, 0);
+    rowValue.assign(nodeNum, 0.0);
+    rowDirty.assign(nodeNum, 0);
+}
+
+/**
+ * @description: Turn the link weights of a router into its routing row, integer percentages with a floor of 1
+ *               or fixed-point thresholds depending on probResolution.
+ * @param {int} nodeId  ID of the router
+ * @return {*} None
+ */
+void pfrpTable::normalizeRow(int nodeId)
+{
+    int begin = adjStart[nodeId];
+    int end = adjStart[nodeId + 1];
+    if (probResolution)
+    {
+        installRow(nodeId, &adjWeight[begin]);
+        return;
+    }
+    double totalWeight = 0.0;
+    for (int k = begin; k < end; k++)
+    {
+        totalWeight += adjWeight[k];
+    }
+    for (int k = begin; k < end; k++)
+    {
+        int prob = (int)(adjWeight[k] / totalWeight * 100);
+        if (prob < 1)
+        {
+            prob = 1;
+        }
+        adjProb[k] = prob;
+    }
+}
+
+/**
+ * @description: Apply a sparse update of the routing table, the body of a "d@@..." reply.
+ *               Entries are separated by ';', "edge,weight" in single-agent DRL and "row,col,value"
+ *               in multi-agent DRL, where col must be a neighbor of row and values must be positive, since
+ *               every link stays in the table. An empty body keeps the table.
+ *               Only the rows touched by the update are renormalized and have their thresholds rebuilt.
+ * @param {char} *delta     body of the reply
+ * @return {*} None
+ */
+void pfrpTable::applyDelta(const char *delta)
+{
+    vector<int> dirty;
+    const char *p = delta;
+    char *next;
+    while (*p)
+    {
+        int row;
+        int pos;
+        double value;
+        if (simMode == 1)
+        {
+            long edge = strtol(p, &next, 10);
+            if (next == p || *next != ',' || edge < 0 || edge >= edgeNum * 2)
+            {
+                throw cRuntimeError("pfrpTable: malformed delta entry: %.40s", p);
+            }
+            value = strtod(next + 1, &next);
+            if (!(value > 0))
+            {
+                throw cRuntimeError("pfrpTable: delta gives edge %ld the non-positive weight %g", edge, value);
+            }
+            row = edgeSrc[edge];
+            pos = edgePos[edge];
+        }
+        else
+        {
+            row = int(strtol(p, &next, 10));
+            int col = (*next == ',') ? int(strtol(next + 1, &next, 10)) : -1;
+            pos = (*next == ',' && row >= 0 && row < nodeNum && col >= 0 && col < nodeNum) ? findLink(row, col) : -1;
+            if (pos < 0)
+            {
+                throw cRuntimeError("pfrpTable: malformed delta entry or not a link: %.40s", p);
+            }
+            value = strtod(next + 1, &next);
+            if (!(value > 0) || (!probResolution && int(value) <= 0))
+            {
+                throw cRuntimeError("pfrpTable: delta gives R%d -> R%d the non-positive value %g", row, col, value);
+            }
+            if (!probResolution)
+            {
+                // integer table of multi-agent DRL, used as it is
+                adjProb[pos] = int(value);
+            }
+        }
+        adjWeight[pos] = value;
+        if (!rowDirty[row])
+        {
+            rowDirty[row] = 1;
+            dirty.push_back(row);
+        }
+        if (*next != ';' && *next != '\0')
+        {
+            throw cRuntimeError("pfrpTable: malformed delta entry: %.40s", next);
+        }
+        p = (*next == ';') ? next + 1 : next;
+    }
+
+    for (int row : dirty)
+    {
+        rowDirty[row] = 0;
+        if (simMode == 1)
+            normalizeRow(row);
+        else if (probResolution)
+            installRow(row, &adjWeight[adjStart[row]]);
+    }
+    if (pfrpTelemetry::getInstance()->isEnabled(pfrpTelemetry::LEVEL_DEBUG))
+    {
+        pfrpTelemetry::getInstance()->log(pfrpTelemetry::LEVEL_DEBUG, "delta update: " + to_string(dirty.size()) + " rows");
+    }
+}
+
+/**
+ * @description: Sample next hops from fixed-point thresholds instead of integer percentages,
+ *               so that actions finer than 1% take effect. The current table is converted.
+ * @param {int} bits    resolution of the thresholds, 16 or 32, 0 keeps integer percentages
+ * @return {*} None
+ */
+void pfrpTable::setProbResolution(int bits)
+{
+    if (bits != 0 && bits != 16 && bits != 32)
+    {
+        throw cRuntimeError("pfrpTable: probResolution must be 0, 16 or 32, got %d", bits);
+    }
+    if (bits == probResolution)
+    {
+        return;
+    }
+    probResolution = bits;
+    probThreshold16.assign(bits == 16 ? adjNode.size() : 0, 0);
+    probThreshold32.assign(bits == 32 ? adjNode.size() : 0, 0);
+    for (int i = 0; i < nodeNum && bits; i++)
+    {
+        for (int k = adjStart[i]; k < adjStart[i + 1]; k++)
+        {
+            adjWeight[k] = adjProb[k];
+        }
+        installRow(i, &adjWeight[adjStart[i]]);
+    }
+}
+
+/**
+ * @description: Normalize the weights of the neighbors of a router into its fixed-point thresholds.
+ *               Every neighbor keeps at least one LSB, as the percentage table keeps at least 1%,
+ *               the rounding remainder goes to the last neighbor. Negative weights count as 0,
+ *               a row without positive weight is split evenly.
+ * @param {int} nodeId              ID of the router
+ * @param {double} *weights         weights of adjNode[adjStart[nodeId] ..], contiguous
+ * @return {*} None
+ */
+void pfrpTable::installRow(int nodeId, const double *weights)
+{
+    int begin = adjStart[nodeId];
+    int degree = adjStart[nodeId + 1] - begin;
+    if (degree == 0)
+    {
+        return;
+    }
+    uint64_t scale = uint64_t(1) << probResolution;
+
+    double total = 0.0;
+    for (int k = 0; k < degree; k++)
+    {
+        total += weights[k] > 0.0 ? weights[k] : 0.0;
+    }
+    double spread = total > 0.0 ? double(scale - degree) / total : 0.0;
+    uint64_t even = scale / degree;
+    for (int k = 0; k < degree; k++)
+    {
+        rowWidth[k] = total > 0.0 ? 1 + uint64_t((weights[k] > 0.0 ? weights[k] : 0.0) * spread) : even;
+    }
+
+    uint64_t low = 0;
+    for (int k = 0; k < degree; k++)
+    {
+        uint64_t high = (k == degree - 1) ? scale : low + rowWidth[k];
+        if (probResolution == 16)
+            probThreshold16[begin + k] = uint16_t(high - 1);
+        else
+            probThreshold32[begin + k] = uint32_t(high - 1);
+        int prob = int((high - low) >> (probResolution - 16));
+        adjProb[begin + k] = prob > 0 ? prob : 1;
+        low = high;
+    }
+}
+
+/**
+ * @description: Enable the optional per-link queue occupancy block in the state message.
+ * @param {bool} enable     whether to append the queue block
+ * @return {*} None
+ */
+void pfrpTable::setQueueState(bool enable)
+{
+    queueState = enable;
+}
+
+/**
+ * @description: Name the nodes of the network as elements of the vector submodules R[] and H[]
+ *               instead of the scalar submodules Ri and Hi.
+ * @param {bool} enable     whether the nodes are vector elements
+ * @return {*} None
+ */
+void pfrpTable::setVectorNodes(bool enable)
+{
+    vectorNodes = enable;
+}
+
+/**
+ * @description: Get the ID of a node from its name in a module path.
+ * @param {char} *name      name of the node, such as R3 or R[3]
+ * @return {int}            ID of the node
+ */
+int pfrpTable::parseNodeId(const char *name)
+{
+    return atoi(name + (name[1] == '[' ? 2 : 1));
+}
+
+/**
+ * @description: Get the name of a node that next hops are resolved with.
+ * @param {char} prefix     R for a router, H for a host
+ * @param {int} id          ID of the node
+ * @return {string}         name of the node, such as R3 or R[3]
+ */
+string pfrpTable::nodeName(char prefix, int id) const
+{
+    return vectorNodes ? string(1, prefix) + "[" + to_string(id) + "]" : string(1, prefix) + to_string(id);
+}
+
+/**
+ * @description: Keep the next hop of every (src, dst) flowlet in a direct-mapped cache per router. The first
+ *               packet of a flowlet samples the table, later packets reuse its next hop until the flowlet idles
+ *               for gap seconds or updateProb installs a new table. Colliding flowlets evict each other.
+ * @param {double} gap      idle time that ends a flowlet in s, 0 samples every packet
+ * @param {int} slots       cache entries per router, a power of two
+ * @return {*} None
+ */
+void pfrpTable::setFlowlet(double gap, int slots)
+{
+    if (gap < 0 || slots <= 0 || (slots & (slots - 1)) != 0)
+    {
+        throw cRuntimeError("pfrpTable: flowletGap must be >= 0 and flowletCacheSize a power of two, got %g and %d", gap, slots);
+    }
+    flowletGap = gap;
+    if (gap > 0 && flowletCache.size() != size_t(nodeNum) * slots)
+    {
+        flowletBits = 0;
+        while ((1 << flowletBits) < slots)
+        {
+            flowletBits++;
+        }
+        flowletCache.assign(size_t(nodeNum) * slots, pfrpFlowlet());
+    }
+}
+
+/**
+ * @description: Get the next hop of a flowlet from the cache of the router, sampling the table on a miss.
+ * @param {int} nodeId      ID of current node
+ * @param {int} srcNode     ID of source of current packet
+ * @param {int} dstNode     ID of destination of current packet
+ * @return {int}            ID of the next-hop node
+ */
+int pfrpTable::getFlowletNextNode(int nodeId, int srcNode, int dstNode)
+{
+    double now = simTime().dbl();
+    uint32_t key = uint32_t(srcNode) * nodeNum + dstNode;
+    // Fibonacci hashing, the high bits of the product select the slot
+    uint32_t slot = flowletBits ? (key * 2654435769u) >> (32 - flowletBits) : 0;
+    pfrpFlowlet &flowlet = flowletCache[(size_t(nodeId) << flowletBits) | slot];
+    flowletLookups++;
+    if (flowlet.key == key && flowlet.version == tableVersion && now - flowlet.lastSeen < flowletGap)
+    {
+        flowlet.lastSeen = now;
+        flowletHits++;
+        return flowlet.nextNode;
+    }
+    flowlet.key = key;
+    flowlet.nextNode = getNextNode(nodeId, dstNode);
+    flowlet.version = tableVersion;
+    flowlet.lastSeen = now;
+    return flowlet.nextNode;
+}
+
+/**
+ * @description: Restrict next hops to neighbors strictly closer to the destination in hops, and/or count
+ *               the router-to-router hops that are not. Restricted sampling renormalizes the weights of the
+ *               table over the closer neighbors, so a packet reaches its destination in as many hops as
+ *               its source is away from it and never revisits a router. Hops without progress are detours,
+ *               not necessarily loops. The hop distances are computed per destination on demand.
+ * @param {bool} restrictHops   whether to sample only closer neighbors
+ * @param {bool} countHops      whether to append the "@@detour=" block to the state message
+ * @param {int} distRows        destinations whose hop distances are cached, a miss costs one BFS
+ * @return {*} None
+ */
+void pfrpTable::setLoopFree(bool restrictHops, bool countHops, int distRows)
+{
+    loopFree = restrictHops;
+    detourStats = countHops;
+    if (!loopFree && !detourStats)
+    {
+        return;
+    }
+    if (nodeNum > UINT16_MAX)
+    {
+        throw cRuntimeError("pfrpTable: hop distances support at most %d nodes", UINT16_MAX);
+    }
+    if (distRows <= 0)
+    {
+        throw cRuntimeError("pfrpTable: hopDistRows must be positive, got %d", distRows);
+    }
+    hopDistSlots = min(distRows, nodeNum);
+    hopDistCache.assign(size_t(hopDistSlots) * nodeNum, UINT16_MAX);
+    hopDistOwner.assign(hopDistSlots, -1);
+    hopDistFrontier.assign(nodeNum, 0);
+    if (detourStats)
+    {
+        nonProgressOfStep.assign(totalStep, 0);
+        routedOfStep.assign(totalStep, 0);
+    }
+}
+
+/**
+ * @description: Compute the hop distance of every router to a destination by one BFS from it, links are
+ *               bi-directional. Unreachable routers keep UINT16_MAX.
+ * @param {int} dst                 the destination
+ * @param {uint16_t} *dist          nodeNum distances, all UINT16_MAX on entry
+ * @param {vector<int>} &frontier   queue of the BFS, nodeNum entries
+ * @return {*} None
+ */
+void pfrpTable::bfsHops(int dst, uint16_t *dist, vector<int> &frontier) const
+{
+    dist[dst] = 0;
+    frontier[0] = dst;
+    for (int head = 0, tail = 1; head < tail; head++)
+    {
+        int node = frontier[head];
+        for (int k = adjStart[node]; k < adjStart[node + 1]; k++)
+        {
+            if (dist[adjNode[k]] == UINT16_MAX)
+            {
+                dist[adjNode[k]] = dist[node] + 1;
+                frontier[tail++] = adjNode[k];
+            }
+        }
+    }
+}
+
+/**
+ * @description: Get the hop distances towards a destination from its slot of the cache, replacing the
+ *               destination the slot held by one BFS on a miss.
+ * @param {int} dst             the destination
+ * @return {uint16_t*}          nodeNum distances, valid until the next call for another destination
+ */
+const uint16_t *pfrpTable::getHopDist(int dst)
+{
+    int slot = dst % hopDistSlots;
+    uint16_t *dist = &hopDistCache[size_t(slot) * nodeNum];
+    if (hopDistOwner[slot] != dst)
+    {
+        fill(dist, dist + nodeNum, UINT16_MAX);
+        bfsHops(dst, dist, hopDistFrontier);
+        hopDistOwner[slot] = dst;
+    }
+    return dist;
+}
+
+/**
+ * @description: Sample a next hop among the neighbors strictly closer to the destination, with the weights
+ *               of the current table restricted to them. Closer neighbors without weight are drawn evenly
+ *               when none of them has any.
+ * @param {int} nodeId      ID of current node
+ * @param {int} dstNode     ID of destination of current packet
+ * @return {int}            ID of the next-hop node, -1 if no neighbor is closer (dstNode unreachable)
+ */
+int pfrpTable::sampleCloser(int nodeId, int dstNode)
+{
+    const uint16_t *dist = getHopDist(dstNode);
+    int begin = adjStart[nodeId];
+    int end = adjStart[nodeId + 1];
+    uint64_t total = 0;
+    uint32_t closer = 0;
+    for (int k = begin; k < end; k++)
+    {
+        if (dist[adjNode[k]] < dist[nodeId])
+        {
+            // the width of a fixed-point interval is the probability of its neighbor
+            if (probResolution == 16)
+                rowWidth[k - begin] = probThreshold16[k] - (k == begin ? -1 : int(probThreshold16[k - 1]));
+            else if (probResolution == 32)
+                rowWidth[k - begin] = uint64_t(probThreshold32[k]) - (k == begin ? -1 : int64_t(probThreshold32[k - 1]));
+            else
+                rowWidth[k - begin] = max(adjProb[k], 0);
+            total += rowWidth[k - begin];
+            closer++;
+        }
+        else
+        {
+            rowWidth[k - begin] = 0;
+        }
+    }
+    if (!closer)
+    {
+        return -1;
+    }
+
+    // total is at most 2^32, so the scaled draw stays below total
+    uint64_t draw = total ? (uint64_t(routerRng[nodeId].next()) * total) >> 32 : routerRng[nodeId].below(closer);
+    int last = -1;
+    for (int k = begin; k < end; k++)
+    {
+        if (dist[adjNode[k]] >= dist[nodeId])
+        {
+            continue;
+        }
+        last = k;
+        uint64_t width = total ? rowWidth[k - begin] : 1;
+        if (draw < width)
+        {
+            return adjNode[k];
+        }
+        draw -= width;
+    }
+    return adjNode[last];
+}
+
+/**
+ * @description: Record the propagation delay and datarate of the link behind the gateIndex-th point-to-point
+ *               interface of a router, used by the lower bounds of exceedsSurvival. The routers report their
+ *               links at INITSTAGE_NETWORK_LAYER, before setDelayBound.
+ * @param {int} nodeId          ID of the router
+ * @param {int} gateIndex       index of the point-to-point interface
+ * @param {double} delay        propagation delay of the link, unit: s
+ * @param {double} datarate     datarate of the link, unit: bps, 0 for an infinite datarate
+ * @return {*} None
+ */
+void pfrpTable::setLinkDelay(int nodeId, int gateIndex, double delay, double datarate)
+{
+    int edge = getEdgeId(nodeId, gateIndex);
+    if (edge < 0)
+    {
+        throw cRuntimeError("pfrpTable: R%d has no link behind interface %d", nodeId, gateIndex);
+    }
+    linkDelay[edge] = delay;
+    linkInvRate[edge] = datarate > 0.0 ? 1.0 / datarate : 0.0;
+}
+
+/**
+ * @description: Note that a router drops packets that can no longer arrive within survivalTime, called by the
+ *               routers with earlyDrop at INITSTAGE_NETWORK_LAYER.
+ * @return {*} None
+ */
+void pfrpTable::enableEarlyDrop()
+{
+    delayBoundUsed = true;
+}
+
+/**
+ * @description: Compute the lower bounds of exceedsSurvival if a router drops packets early. Only the first
+ *               call takes effect, every application instance calls it at INITSTAGE_APPLICATION_LAYER, after
+ *               the routers have reported their links, so no packet event has to build them.
+ * @return {*} None
+ */
+void pfrpTable::setDelayBound()
+{
+    if (!delayBoundUsed || !minPropDelay.empty())
+    {
+        return;
+    }
+    buildDelayBound();
+}
+
+/**
+ * @description: Compute the lower bounds of the delay from every router to every destination router, with one
+ *               thread per core taking destinations in turn. Every thread fills the rows of its destinations in place.
+ * @return {*} None
+ */
+void pfrpTable::buildDelayBound()
+{
+    minPropDelay.assign(size_t(nodeNum) * nodeNum, 0.0f);
+    minInvRate.assign(size_t(nodeNum) * nodeNum, 0.0f);
+    atomic<int> nextDestination(0);
+    int threadNum = max(1, min(nodeNum, int(thread::hardware_concurrency())));
+    vector<thread> workers;
+    for (int t = 0; t < threadNum; t++)
+    {
+        workers.emplace_back([&]()
+                             {
+                                 for (int dst = nextDestination++; dst < nodeNum; dst = nextDestination++)
+                                 {
+                                     delayBoundDestination(dst);
+                                 } });
+    }
+    for (thread &worker : workers)
+    {
+        worker.join();
+    }
+    pfrpTelemetry::getInstance()->log(pfrpTelemetry::LEVEL_INFO, "---- delay bound ---- " + to_string(nodeNum) + " destinations, on " +
+                                                                     to_string(threadNum) + " threads");
+}
+
+/**
+ * @description: Compute the lower bounds of the delay from every router to a destination router. The
+ *               propagation delays and the inverse datarates are minimized by separate Dijkstra runs,
+ *               their sum for a packet is a lower bound of the delay on any single path.
+ * @param {int} dstNode     ID of the destination
+ * @return {*} None
+ */
+void pfrpTable::delayBoundDestination(int dstNode)
+{
+    vector<double> dist(nodeNum);
+    priority_queue<pair<double, int>, vector<pair<double, int>>, greater<pair<double, int>>> heap;
+    for (int term = 0; term < 2; term++)
+    {
+        const vector<double> &cost = term == 0 ? linkDelay : linkInvRate;
+        float *bound = &(term == 0 ? minPropDelay : minInvRate)[size_t(dstNode) * nodeNum];
+        dist.assign(nodeNum, HUGE_VAL);
+        dist[dstNode] = 0.0;
+        heap.push(make_pair(0.0, dstNode));
+        while (!heap.empty())
+        {
+            double d = heap.top().first;
+            int node = heap.top().second;
+            heap.pop();
+            if (d > dist[node])
+            {
+                continue;
+            }
+            for (int k = adjStart[node]; k < adjStart[node + 1]; k++)
+            {
+                // the link towards node is the reverse of adjEdge[k]
+                double via = d + cost[adjEdge[k] ^ 1];
+                if (via < dist[adjNode[k]])
+                {
+                    dist[adjNode[k]] = via;
+                    heap.push(make_pair(via, adjNode[k]));
+                }
+            }
+        }
+        for (int i = 0; i < nodeNum; i++)
+        {
+            float rounded = float(dist[i]);
+            bound[i] = rounded > dist[i] ? nextafterf(rounded, 0.0f) : rounded;
+        }
+    }
+}
+
+/**
+ * @description: Whether a packet leaving a router can no longer reach its destination router within
+ *               survivalTime, even on the fastest links without queueing. Such a packet would be dropped
+ *               for its survivalTime at a later router at the latest.
+ * @param {int} nodeId          ID of current router
+ * @param {char} *pkName        name of the packet
+ * @param {double} age          time since the packet was created, unit: s
+ * @param {int64_t} bits        size of the packet, unit: bit
+ * @return {bool}               true if the packet cannot arrive in time
+ */
+bool pfrpTable::exceedsSurvival(int nodeId, const char *pkName, double age, int64_t bits)
+{
+    // a pkName example: H0-H5-pfrp-4387-0
+    const char *dstName = strchr(pkName, '-');
+    if (dstName == NULL)
+    {
+        return false;
+    }
+    int dstNodeId = atoi(dstName + 2);
+    if (dstNodeId == nodeId || dstNodeId < 0 || dstNodeId >= nodeNum)
+    {
+        return false;
+    }
+    if (minPropDelay.empty())
+    {
+        throw cRuntimeError("pfrpTable: the delay bounds of early drops are computed by setDelayBound at initialization");
+    }
+    size_t pos = size_t(dstNodeId) * nodeNum + nodeId;
+    return age + minPropDelay[pos] + double(bits) * minInvRate[pos] >= survivalTime;
+}
+
+/**
+ * @description: Count a packet dropped by a router in the statistics of its step, and of the link it was to
+ *               leave on since the last reward. Early drops are counted as survivalTime drops too.
+ * @param {int} nodeId      ID of the router, -1 for a host
+ * @param {int} gateIndex   index of the point-to-point interface the packet was to leave on, -1 for none
+ * @param {char} *pkName    name of the packet, the step is its fifth field
+ * @param {int} reason      a DropReason
+ * @return {*} None
+ */
+void pfrpTable::countDrop(int nodeId, int gateIndex, const char *pkName, int reason)
+{
+    // the path index of simMode 3 may follow the step
+    const char *stepStr = pkName;
+    for (int field = 0; field < 4 && stepStr; field++)
+    {
+        stepStr = strchr(stepStr, '-');
+        stepStr = stepStr ? stepStr + 1 : NULL;
+    }
+    int step = stepStr ? atoi(stepStr) : -1;
+    if (step >= 0 && step < totalStep)
+    {
+        if (reason == DROP_TTL)
+        {
+            ttlDrop[step]++;
+        }
+        else
+        {
+            stDrop[step]++;
+            if (reason == DROP_EARLY)
+                earlyDrop[step]++;
+        }
+    }
+    int edge = getEdgeId(nodeId, gateIndex);
+    if (edge < 0)
+    {
+        return;
+    }
+    linkDrop[reason * edgeNum * 2 + edge]++;
+    if (reason == DROP_EARLY)
+    {
+        linkDrop[DROP_SURVIVAL * edgeNum * 2 + edge]++;
+    }
+}
+
+/**
+ * @description: Append the drop counts of a step and of every link to the reward message.
+ * @param {bool} enable     whether to append the drop blocks
+ * @return {*} None
+ */
+void pfrpTable::setDropStats(bool enable)
+{
+    dropStats = enable;
+}
+
+/**
+ * @description: Append the drop blocks of a step to a reward message, "@@drop=ttl,survival,early" for the
+ *               packets of the step, then per link since the last reward, ordered by topo edge id,
+ *               "@@dropttl=...", "@@dropst=..." and "@@dropearly=...". The per-link counts are reset.
+ * @param {string} &reqStr  reward message
+ * @param {int} step        step of the reward
+ * @return {*} None
+ */
+void pfrpTable::appendDropBlocks(string &reqStr, int step)
+{
+    reqStr += "@@drop=" + to_string(ttlDrop[step]) + "," + to_string(stDrop[step]) + "," + to_string(earlyDrop[step]);
+    const char *names[DROP_REASON_NUM] = {"@@dropttl=", "@@dropst=", "@@dropearly="};
+    for (int reason = 0; reason < DROP_REASON_NUM; reason++)
+    {
+        reqStr += names[reason];
+        for (int e = 0; e < edgeNum * 2; e++)
+        {
+            reqStr += to_string(linkDrop[reason * edgeNum * 2 + e]) + (e == edgeNum * 2 - 1 ? "" : ",");
+        }
+    }
+    fill(linkDrop.begin(), linkDrop.end(), 0);
+}
+
+/**
+ * @description: Record a change of the number of packets waiting in the queue of a router interface.
+ *               The time-weighted integral is advanced before the change, so the step average costs O(1) per event.
+ * @param {int} nodeId          ID of the router
+ * @param {int} gateIndex       index of the point-to-point interface
+ * @param {int} delta           change of the queue length, unit: packet
+ * @param {double} currentTime  current timestamp in omnetpp environment
+ * @return {*} None
+ */
+void pfrpTable::countQueueLength(int nodeId, int gateIndex, int delta, double currentTime)
+{
+    int edge = getEdgeId(nodeId, gateIndex);
+    if (edge < 0)
+    {
+        return;
+    }
+    queueArea[edge] += queueLen[edge] * (currentTime - queueLastTime[edge]);
+    queueLastTime[edge] = currentTime;
+    queueLen[edge] += delta;
+}
+
+/**
+ * @description: Record the queueing delay of a packet leaving the queue of a router interface.
+ * @param {int} nodeId      ID of the router
+ * @param {int} gateIndex   index of the point-to-point interface
+ * @param {double} delay    time the packet spent in the queue, unit: s
+ * @return {*} None
+ */
+void pfrpTable::countQueueDelay(int nodeId, int gateIndex, double delay)
+{
+    int edge = getEdgeId(nodeId, gateIndex);
+    if (edge < 0)
+    {
+        return;
+    }
+    queueDelaySum[edge] += delay;
+    queueDelayCount[edge]++;
+}
+
+/**
+ * @description: Seed the next-hop sampling stream of every router from the simulation seed.
+ *               Router i draws from stream i of the seed, so a run can be reproduced from the seed alone.
+ * @param {uint64_t} seed   simulation seed, e.g. seed-0-mt in omnetpp.ini
+ * @return {*} None
+ */
+void pfrpTable::setSeed(uint64_t seed)
+{
+    routerRng.clear();
+    for (int i = 0; i < nodeNum; i++)
+    {
+        routerRng.push_back(pfrpRng(seed, i));
+    }
+}
+
+/**
+ * @description: Send a message to python and block until its reply arrives,
+ *               through the shared-memory region if one is mapped, over ZMQ otherwise.
+ * @param {string} &reqStr          message to be sent
+ * @param {size_t} &replySize       bytes of the reply from python
+ * @return {char *}                 reply from python, valid until the next exchange
+ */
+const char *pfrpTable::exchange(const string &reqStr, size_t &replySize)
+{
+    PFRP_TIMING_BEGIN(PHASE_ZMQ_WAIT);
+    const char *reply;
+    if (shm.isOpen())
+    {
+        reply = shm.exchange(reqStr.data(), reqStr.size(), replySize);
+    }
+    else
+    {
+        zmq::message_t request{reqStr.size()};
+        memcpy(request.data(), reqStr.data(), reqStr.size());
+        zmqSocket.send(request);
+        zmqSocket.recv(&zmqReply);
+        reply = (const char *)zmqReply.data();
+        replySize = zmqReply.size();
+    }
+    PFRP_TIMING_END(PHASE_ZMQ_WAIT);
+    return reply;
+}
+
+/**
+ * @description: Exchange messages with python through a shared-memory region instead of ZMQ over TCP.
+ * @param {char} *name  name of the region under /dev/shm, created by python, empty to keep ZMQ
+ * @return {*} None
+ */
+void pfrpTable::setShmName(const char *name)
+{
+    if (name && *name)
+    {
+        shm.open(name);
+    }
+}
+
+/**
+ * @description: Split the routers of multi-agent DRL into groups, each with its own agent endpoint.
+ *               Router i belongs to group i * groups / nodeNum (integer division), group g connects
+ *               a DEALER socket to port zmqPort + 1 + g, where a ROUTER socket of its agent is bound.
+ * @param {int} groups  number of groups, 0 keeps the single REQ socket
+ * @return {*} None
+ */
+void pfrpTable::setAgentGroups(int groups)
+{
+    if (simMode != 2 || groups <= 0 || agentGroups > 0)
+    {
+        return;
+    }
+    if (groups > nodeNum)
+    {
+        throw cRuntimeError("pfrpTable: agentGroups (%d) exceeds the number of nodes (%d)", groups, nodeNum);
+    }
+    agentGroups = groups;
+    for (int g = 0; g < groups; g++)
+    {
+        zmq::socket_t *socket = new zmq::socket_t(zmqContext, ZMQ_DEALER);
+        socket->setsockopt(ZMQ_LINGER, 0);
+        socket->connect("tcp://localhost:" + to_string(zmqPort + 1 + g));
+        groupSockets.push_back(socket);
+    }
+}
+
+/**
+ * @description: Send a message of a router to the agent of its group, without waiting for the reply.
+ * @param {int} nodeId          ID of the router
+ * @param {string} &message     message to be sent
+ * @return {*} None
+ */
+void pfrpTable::sendToGroup(int nodeId, const string &message)
+{
+    zmq::message_t request{message.size()};
+    memcpy(request.data(), message.data(), message.size());
+    groupSockets[(long)nodeId * agentGroups / nodeNum]->send(request);
+}
+
+/**
+ * @description: Send the local observation of every router to its group, then gather the routing rows.
+ *               The observation of router i is "s@@step@@i@@" followed by row i of the traffic matrix and,
+ *               with queueState, the queue blocks of its outgoing links in ascending neighbor order, then
+ *               with detourStats the "@@detour=" block of the whole network, as in the single-socket state.
+ *               The reply is "i@@p_i0,...,p_i(nodeNum-1)", the dense row i of the routing table.
+ * @param {int} step    the step whose state is sent
+ * @return {*} None
+ */
+void pfrpTable::exchangeGroups(int step)
+{
+    PFRP_TIMING_BEGIN(PHASE_STATE);
+    bool recording = pfrpRecorder::getInstance()->isOpen();
+    recordRow.clear();
+    if (queueState)
+    {
+        closeQueueInterval(stepEndTime[step]);
+    }
+    string detourStr;
+    if (detourStats)
+    {
+        detourStr = "@@detour=" + to_string(nonProgressOfStep[step]) + "," + to_string(routedOfStep[step]);
+    }
+    for (int i = 0; i < nodeNum; i++)
+    {
+        string obs = "s@@" + to_string(step) + "@@" + to_string(i) + "@@";
+        for (int j = 0, k = adjStart[i]; j < nodeNum; j++)
+        {
+            int bytes = (k < adjStart[i + 1] && adjNode[k] == j) ? pkct[adjEdge[k++]] : 0;
+            double traffic = double(bytes) / 1024 / 1024;
+            if (recording)
+                recordRow.push_back(traffic);
+            obs += to_string(traffic) + (j == nodeNum - 1 ? "" : ",");
+        }
+        if (queueState)
+        {
+            string lenStr = "@@qlen=";
+            string delayStr = "@@qdelay=";
+            for (int k = adjStart[i]; k < adjStart[i + 1]; k++)
+            {
+                lenStr += to_string(queueAvgLen[adjEdge[k]]) + (k == adjStart[i + 1] - 1 ? "" : ",");
+                delayStr += to_string(queueAvgDelay[adjEdge[k]]) + (k == adjStart[i + 1] - 1 ? "" : ",");
+            }
+            obs += lenStr + delayStr;
+        }
+        obs += detourStr;
+        sendToGroup(i, obs);
+    }
+    cleanPkctAndTps();
+    if (recording)
+    {
+        if (queueState)
+        {
+            recordRow.insert(recordRow.end(), queueAvgLen.begin(), queueAvgLen.end());
+            recordRow.insert(recordRow.end(), queueAvgDelay.begin(), queueAvgDelay.end());
+        }
+        if (detourStats)
+        {
+            recordRow.push_back(nonProgressOfStep[step]);
+            recordRow.push_back(routedOfStep[step]);
+        }
+        pfrpRecorder::getInstance()->record(pfrpRecorder::STREAM_STATE, step, recordRow.data(), recordRow.size());
+    }
+    PFRP_TIMING_END(PHASE_STATE);
+
+    gatherGroupReplies(true);
+
+    if (recording)
+    {
+        if (simMode == 3)
+        {
+            pfrpRecorder::getInstance()->record(pfrpRecorder::STREAM_ACTION, step, pathWeight.data(), pathWeight.size());
+        }
+        else
+        {
+            expandRows(adjProb, 0, denseRow);
+            pfrpRecorder::getInstance()->record(pfrpRecorder::STREAM_ACTION, step, denseRow.data(), denseRow.size());
+        }
+    }
+}
+
+/**
+ * @description: Wait until every router has been answered, polling all group sockets at once,
+ *               so that the groups compute their replies concurrently. Rows are installed as they arrive,
+ *               overlapped with the wait for the other groups.
+ * @param {bool} installRows    whether the replies are routing rows to be installed, otherwise acknowledgements
+ * @return {*} None
+ */
+void pfrpTable::gatherGroupReplies(bool installRows)
+{
+    PFRP_TIMING_BEGIN(PHASE_ZMQ_WAIT);
+    vector<zmq::pollitem_t> items(agentGroups);
+    for (int g = 0; g < agentGroups; g++)
+    {
+        items[g] = {(void *)*groupSockets[g], 0, ZMQ_POLLIN, 0};
+    }
+    int received = 0;
+    zmq::message_t reply;
+    while (received < nodeNum)
+    {
+        zmq::poll(items.data(), items.size(), -1);
+        for (int g = 0; g < agentGroups; g++)
+        {
+            if (!(items[g].revents & ZMQ_POLLIN))
+            {
+                continue;
+            }
+            while (groupSockets[g]->recv(&reply, ZMQ_DONTWAIT))
+            {
+                received++;
+                if (installRows)
+                {
+                    installGroupRow((const char *)reply.data(), reply.size());
+                }
+            }
+        }
+    }
+    PFRP_TIMING_END(PHASE_ZMQ_WAIT);
+}
+
+/**
+ * @description: Install a routing row received from a group, "i@@p_i0,...,p_i(nodeNum-1)".
+ * @param {char} *data  reply of the group
+ * @param {size_t} size bytes of the reply
+ * @return {*} None
+ */
+void pfrpTable::installGroupRow(const char *data, size_t size)
+{
+    groupReply.assign(data, size);
+    char *next;
+    long nodeId = strtol(groupReply.c_str(), &next, 10);
+    if (next == groupReply.c_str() || strncmp(next, "@@", 2) != 0 || nodeId < 0 || nodeId >= nodeNum)
+    {
+        throw cRuntimeError("pfrpTable: malformed reply of an agent group: %.40s", groupReply.c_str());
+    }
+    const char *p = next + 2;
+    for (int j = 0; j < nodeNum; j++)
+    {
+        rowValue[j] = strtod(p, &next);
+        p = (*next == ',') ? next + 1 : next;
+    }
+    installValues(nodeId);
+}
+
+/**
+ * @description: Install the routing row of a router from a dense row of a multi-agent action in rowValue.
+ *               Only the entries of its neighbors are used: integer percentages with probResolution 0,
+ *               otherwise weights whose fractional values are kept.
+ * @param {int} nodeId  ID of the router
+ * @return {*} None
+ */
+void pfrpTable::installValues(int nodeId)
+{
+    for (int k = adjStart[nodeId]; k < adjStart[nodeId + 1]; k++)
+    {
+        if (probResolution)
+            adjWeight[k] = rowValue[adjNode[k]];
+        else
+            adjProb[k] = int(rowValue[adjNode[k]]);
+    }
+    if (probResolution)
+    {
+        installRow(nodeId, &adjWeight[adjStart[nodeId]]);
+    }
+}
+
+/**
+ * @description: Close the queue sampling interval at the end of a step, into queueAvgLen and queueAvgDelay:
+ *               time-weighted average queue length and average queueing delay of every link over the step.
+ * @param {double} now  end time of the step
+ * @return {*} None
+ */
+void pfrpTable::closeQueueInterval(double now)
+{
+    double duration = now - queueStepStart;
+    queueAvgLen.resize(edgeNum * 2);
+    queueAvgDelay.resize(edgeNum * 2);
+    for (int e = 0; e < edgeNum * 2; e++)
+    {
+        queueArea[e] += queueLen[e] * (now - queueLastTime[e]);
+        queueAvgLen[e] = duration > 0 ? queueArea[e] / duration : double(queueLen[e]);
+        queueAvgDelay[e] = queueDelayCount[e] ? queueDelaySum[e] / queueDelayCount[e] : 0.0;
+
+        queueArea[e] = 0.0;
+        queueLastTime[e] = now;
+        queueDelaySum[e] = 0.0;
+        queueDelayCount[e] = 0;
+    }
+    queueStepStart = now;
+}
+
+/**
+ * @description: Record the state, action and reward of every step for offline RL, see pfrpRecorder.h for the format.
+ * @param {char} *prefix        path of the data and index files without extension, empty to disable
+ * @param {int} chunkSteps      number of steps per columnar chunk
+ * @return {*} None
+ */
+void pfrpTable::setRecordFile(const char *prefix, int chunkSteps)
+{
+    pfrpRecorder::getInstance()->open(prefix, nodeNum, simMode, chunkSteps);
+}
+
+/**
+ * @description: Write one JSON line of per-phase timing counters per step to the given file.
+ *               Records are only written when pfrpTable is compiled with PFRP_TIMING, otherwise the file
+ *               is left untouched and a warning is logged.
+ * @param {char} *file  path of the JSON lines file, empty to disable
+ * @return {*} None
+ */
+void pfrpTable::setTimingFile(const char *file)
+{
+    if (timingStream.is_open() || !file || !*file)
+    {
+        return;
+    }
+#ifndef PFRP_TIMING
+    pfrpTelemetry::getInstance()->log(pfrpTelemetry::LEVEL_WARN, string("timingFile ") + file +
+                                                                     " is ignored, the timing counters are compiled out, build with PFRP_DEFINES=-DPFRP_TIMING");
+#else
+    timingStream.open(file, ios::out | ios::trunc);
+    timingRecordStart = pfrpTimingCounters::now();
+#endif
+}
+
+/**
+ * @description: Append the timing counters of the finished step to the timing file and reset them.
+ *               A record covers the wall-clock time between two consecutive step ends, e.g.
+ *               {"step":3,"simTime":8,"wallNs":1200,"forward":{"ns":300,"calls":5000},...}
+ * @param {int} step            the step that has just ended on all nodes
+ * @param {double} endTime      end time of the step in omnetpp environment
+ * @return {*} None
+ */
+void pfrpTable::writeTimingRecord(int step, double endTime)
+{
+    if (!timingStream.is_open())
+    {
+        return;
+    }
+    int64_t now = pfrpTimingCounters::now();
+    timingStream << "{\"step\":" << step << ",\"simTime\":" << endTime << ",\"wallNs\":" << now - timingRecordStart;
+    for (int i = 0; i < PHASE_NUM; i++)
+    {
+        timingStream << ",\"" << pfrpPhaseNames[i] << "\":{\"ns\":" << timing.ns[i] << ",\"calls\":" << timing.calls[i] << "}";
+    }
+    timingStream << "}\n";
+    timingStream.flush();
+    timing.reset();
+    timingRecordStart = now;
+}
+
+/**
+ * @description: Compute the k shortest loop-free paths in hops of every OD pair for simMode 3, with one thread
+ *               per core taking destinations in turn, so every thread only keeps the hop distances towards its
+ *               current destination. Every path starts with an equal split weight. Called by every app, the
+ *               paths are computed once.
+ * @param {int} k               number of paths per OD pair, fewer if the topology has fewer loop-free paths
+ * @param {char} *pathFile      text file the paths are listed in, "" for none
+ * @return {*} None
+ */
+void pfrpTable::setPathCount(int k, const char *pathFile)
+{
+    if (simMode != 3 || pathCount)
+    {
+        return;
+    }
+    if (k <= 0)
+    {
+        throw cRuntimeError("pfrpTable: pathCount must be positive, got %d", k);
+    }
+    if (nodeNum > UINT16_MAX)
+    {
+        throw cRuntimeError("pfrpTable: hop distances support at most %d nodes", UINT16_MAX);
+    }
+    pathCount = k;
+
+    // paths[dst][src] are the paths of the OD pair (src, dst)
+    vector<vector<vector<vector<int>>>> paths(nodeNum);
+    atomic<int> nextDestination(0);
+    int threadNum = max(1, min(nodeNum, int(thread::hardware_concurrency())));
+    vector<thread> workers;
+    for (int t = 0; t < threadNum; t++)
+    {
+        workers.emplace_back([&]()
+                             {
+                                 for (int dst = nextDestination++; dst < nodeNum; dst = nextDestination++)
+                                 {
+                                     yenPaths(dst, k, paths[dst]);
+                                 } });
+    }
+    for (thread &worker : workers)
+    {
+        worker.join();
+    }
+
+    odPathStart.assign(size_t(nodeNum) * nodeNum + 1, 0);
+    pathNodeStart.assign(1, 0);
+    pathNodes.clear();
+    for (int src = 0; src < nodeNum; src++)
+    {
+        for (int dst = 0; dst < nodeNum; dst++)
+        {
+            odPathStart[size_t(src) * nodeNum + dst] = pathNodeStart.size() - 1;
+            for (vector<int> &path : paths[dst][src])
+            {
+                pathNodes.insert(pathNodes.end(), path.begin(), path.end());
+                pathNodeStart.push_back(pathNodes.size());
+            }
+            vector<vector<int>>().swap(paths[dst][src]);
+        }
+    }
+    odPathStart.back() = pathNodeStart.size() - 1;
+    pathWeight.assign(pathNodeStart.size() - 1, 1.0);
+
+    pfrpTelemetry::getInstance()->log(pfrpTelemetry::LEVEL_INFO, "---- paths ---- " + to_string(pathWeight.size()) + " paths, at most " +
+                                                                     to_string(k) + " per OD pair, on " + to_string(threadNum) + " threads");
+    if (pathFile && pathFile[0])
+    {
+        writePathFile(pathFile);
+    }
+}
+
+/**
+ * @description: Find a path with the fewest hops avoiding blocked routers and links, by A* search with the
+ *               unrestricted hop distance to the destination in search.estimate as the estimate. The estimate never exceeds the
+ *               restricted distance and changes by at most one per hop, so the first time the destination is
+ *               taken from the buckets its path is shortest. Routers of a bucket are expanded in the order
+ *               they were reached, so ties are always broken the same way.
+ * @param {int} from                    first router of the path
+ * @param {int} to                      last router of the path
+ * @param {vector<char>} &nodeBlocked   routers the path may not visit
+ * @param {vector<char>} &edgeBlocked   topo edge ids the path may not use
+ * @param {pfrpPathSearch} &search      workspace of the calling thread, its estimate is towards to
+ * @param {vector<int>} &path           the routers of the path from from to to
+ * @return {bool}                       whether a path exists
+ */
+bool pfrpTable::shortestPath(int from, int to, const vector<char> &nodeBlocked, const vector<char> &edgeBlocked,
+                             pfrpPathSearch &search, vector<int> &path) const
+{
+    const uint16_t *estimate = search.estimate.data();
+    if (estimate[from] == UINT16_MAX)
+    {
+        return false;
+    }
+    size_t bound = estimate[from];
+    search.dist[from] = 0;
+    search.parent[from] = from;
+    search.touched.push_back(from);
+    search.buckets[0].push_back(from);
+    size_t lastBucket = 0;
+    bool found = false;
+    for (size_t b = 0; b <= lastBucket && !found; b++)
+    {
+        // a bucket may grow while it is expanded, by hops that keep the estimated length
+        for (size_t q = 0; q < search.buckets[b].size(); q++)
+        {
+            int u = search.buckets[b][q];
+            if (search.dist[u] + estimate[u] - bound != b)
+            {
+                continue; // reached again by a shorter path since
+            }
+            if (u == to)
+            {
+                found = true;
+                break;
+            }
+            for (int k = adjStart[u]; k < adjStart[u + 1]; k++)
+            {
+                int v = adjNode[k];
+                int d = search.dist[u] + 1;
+                if (nodeBlocked[v] || edgeBlocked[adjEdge[k]] || (search.dist[v] >= 0 && search.dist[v] <= d))
+                    continue;
+                if (search.dist[v] < 0)
+                    search.touched.push_back(v);
+                search.dist[v] = d;
+                search.parent[v] = u;
+                size_t vb = d + estimate[v] - bound;
+                if (vb >= search.buckets.size())
+                    search.buckets.resize(vb + 1);
+                search.buckets[vb].push_back(v);
+                lastBucket = max(lastBucket, vb);
+            }
+        }
+    }
+    if (found)
+    {
+        path.clear();
+        for (int v = to; v != from; v = search.parent[v])
+        {
+            path.push_back(v);
+        }
+        path.push_back(from);
+        reverse(path.begin(), path.end());
+    }
+    for (int v : search.touched)
+    {
+        search.parent[v] = -1;
+        search.dist[v] = -1;
+    }
+    search.touched.clear();
+    for (size_t b = 0; b <= lastBucket; b++)
+    {
+        search.buckets[b].clear();
+    }
+    return found;
+}
+
+/**
+ * @description: Compute the k shortest loop-free paths in hops from every other router to a router with
+ *               Yen's algorithm. Every search of the destination shares one BFS from it as its estimate.
+ *               Candidates of equal length are taken in lexicographic order of their routers, so the paths
+ *               do not depend on the thread that computes them.
+ * @param {int} dstNode                             destination router
+ * @param {int} k                                   number of paths per source
+ * @param {vector<vector<vector<int>>>} &paths      for every source, its paths as lists of routers
+ * @return {*} None
+ */
+void pfrpTable::yenPaths(int dstNode, int k, vector<vector<vector<int>>> &paths) const
+{
+    vector<char> nodeBlocked(nodeNum, 0);
+    vector<char> edgeBlocked(edgeNum * 2, 0);
+    pfrpPathSearch search;
+    search.parent.assign(nodeNum, -1);
+    search.dist.assign(nodeNum, -1);
+    search.buckets.resize(1);
+    search.estimate.assign(nodeNum, UINT16_MAX);
+    search.frontier.assign(nodeNum, 0);
+    bfsHops(dstNode, search.estimate.data(), search.frontier);
+    vector<int> path;
+    vector<int> blockedEdges;
+    paths.assign(nodeNum, vector<vector<int>>());
+    for (int srcNode = 0; srcNode < nodeNum; srcNode++)
+    {
+        if (srcNode == dstNode || !shortestPath(srcNode, dstNode, nodeBlocked, edgeBlocked, search, path))
+        {
+            continue;
+        }
+        vector<vector<int>> &found = paths[srcNode];
+        found.push_back(path);
+        set<pair<size_t, vector<int>>> candidates;
+        while (int(found.size()) < k)
+        {
+            const vector<int> last = found.back();
+            for (size_t i = 0; i + 1 < last.size(); i++)
+            {
+                // deviate at last[i]: the found paths sharing the root last[0..i] may not leave it the same way,
+                // and the root routers before last[i] may not be revisited
+                blockedEdges.clear();
+                for (const vector<int> &p : found)
+                {
+                    if (p.size() > i + 1 && equal(p.begin(), p.begin() + i + 1, last.begin()))
+                    {
+                        int edge = adjEdge[findLink(p[i], p[i + 1])];
+                        if (!edgeBlocked[edge])
+                        {
+                            edgeBlocked[edge] = 1;
+                            blockedEdges.push_back(edge);
+                        }
+                    }
+                }
+                for (size_t r = 0; r < i; r++)
+                {
+                    nodeBlocked[last[r]] = 1;
+                }
+                if (shortestPath(last[i], dstNode, nodeBlocked, edgeBlocked, search, path))
+                {
+                    vector<int> total(last.begin(), last.begin() + i);
+                    total.insert(total.end(), path.begin(), path.end());
+                    if (find(found.begin(), found.end(), total) == found.end())
+                    {
+                        candidates.insert(make_pair(total.size(), total));
+                    }
+                }
+                for (size_t r = 0; r < i; r++)
+                {
+                    nodeBlocked[last[r]] = 0;
+                }
+                for (int edge : blockedEdges)
+                {
+                    edgeBlocked[edge] = 0;
+                }
+            }
+            if (candidates.empty())
+            {
+                break;
+            }
+            found.push_back(candidates.begin()->second);
+            candidates.erase(candidates.begin());
+        }
+    }
+}
+
+/**
+ * @description: Write the paths of every OD pair to a text file, one "pathId,src,dst,index,r0 r1 ... rn" line
+ *               per path. The action of the agent gives one weight per line, in this order.
+ * @param {char} *pathFile      path of the text file
+ * @return {*} None
+ */
+void pfrpTable::writePathFile(const char *pathFile)
+{
+    ofstream file(pathFile, ios::out | ios::trunc);
+    if (!file)
+    {
+        throw cRuntimeError("pfrpTable: cannot write the path file %s", pathFile);
+    }
+    file << "# pathId,src,dst,index,routers\n";
+    for (int src = 0; src < nodeNum; src++)
+    {
+        for (int dst = 0; dst < nodeNum; dst++)
+        {
+            size_t od = size_t(src) * nodeNum + dst;
+            for (int p = odPathStart[od]; p < odPathStart[od + 1]; p++)
+            {
+                file << p << ',' << src << ',' << dst << ',' << p - odPathStart[od] << ',';
+                for (int n = pathNodeStart[p]; n < pathNodeStart[p + 1]; n++)
+                {
+                    file << pathNodes[n] << (n + 1 < pathNodeStart[p + 1] ? " " : "\n");
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @description: Sample the index of the path of a packet among the paths of its OD pair, in proportion to
+ *               their weights, from the stream of the source router. Uniform if no weight is positive.
+ * @param {int} srcNode     ID of the source
+ * @param {int} dstNode     ID of the destination
+ * @return {int}            index of the path among the paths of the pair
+ */
+int pfrpTable::samplePath(int srcNode, int dstNode)
+{
+    size_t od = size_t(srcNode) * nodeNum + dstNode;
+    int begin = odPathStart[od];
+    int count = odPathStart[od + 1] - begin;
+    if (count <= 1)
+    {
+        return 0;
+    }
+    double sum = 0;
+    for (int p = begin; p < begin + count; p++)
+    {
+        sum += max(pathWeight[p], 0.0);
+    }
+    pfrpRng &rng = routerRng[srcNode];
+    if (sum <= 0)
+    {
+        return int(rng.below(count));
+    }
+    double draw = rng.next() * (sum / 4294967296.0);
+    for (int i = 0; i < count - 1; i++)
+    {
+        draw -= max(pathWeight[begin + i], 0.0);
+        if (draw < 0)
+            return i;
+    }
+    return count - 1;
+}
+
+/**
+ * @description: Get the router after the current one on the path stamped into a packet, a lookup instead
+ *               of sampling. A packet off its path, which only an invalid index can cause, is sampled.
+ * @param {int} nodeId      ID of current node
+ * @param {int} srcNode     ID of the source of the packet
+ * @param {int} dstNode     ID of the destination of the packet
+ * @param {int} pathIndex   index of the path among the paths of the pair
+ * @return {int}            ID of the next-hop node
+ */
+int pfrpTable::getPathNextNode(int nodeId, int srcNode, int dstNode, int pathIndex)
+{
+    size_t od = size_t(srcNode) * nodeNum + dstNode;
+    int p = odPathStart[od] + pathIndex;
+    if (pathIndex >= 0 && p < odPathStart[od + 1])
+    {
+        for (int n = pathNodeStart[p]; n < pathNodeStart[p + 1] - 1; n++)
+        {
+            if (pathNodes[n] == nodeId)
+            {
+                return pathNodes[n + 1];
+            }
+        }
+    }
+    return getNextNode(nodeId, dstNode);
+}
+
+/**
+ * @description: Apply a sparse update of the path split weights, entries "pathId,weight" separated by ';'.
+ *               An empty body keeps the weights.
+ * @param {char} *delta     body of the reply
+ * @return {*} None
+ */
+void pfrpTable::applyPathDelta(const char *delta)
+{
+    const char *p = delta;
+    char *next;
+    while (*p)
+    {
+        long path = strtol(p, &next, 10);
+        if (next == p || *next != ',' || path < 0 || path >= long(pathWeight.size()))
+        {
+            throw cRuntimeError("pfrpTable: malformed path delta entry: %.40s", p);
+        }
+        pathWeight[path] = strtod(next + 1, &next);
+        if (*next != ';' && *next != '\0')
+        {
+            throw cRuntimeError("pfrpTable: malformed path delta entry: %.40s", next);
+        }
+        p = (*next == ';') ? next + 1 : next;
+    }
+}
+
+/**
+ * @description: Select the cost of the shortest paths of simMode 4 and compute the next hops. Only the first
+ *               call takes effect, every application instance passes the same parameters. The propagation
+ *               delays are reported by the routers at INITSTAGE_NETWORK_LAYER, so the applications call this
+ *               at INITSTAGE_APPLICATION_LAYER.
+ * @param {char} *metric    "hop" for the fewest hops, "delay" for the least propagation delay, ties broken by hops
+ * @return {*} None
+ */
+void pfrpTable::setShortestPath(const char *metric)
+{
+    if (strcmp(metric, "hop") != 0 && strcmp(metric, "delay") != 0)
+    {
+        throw cRuntimeError("pfrpTable: spMetric must be \"hop\" or \"delay\", got \"%s\"", metric);
+    }
+    if (simMode != 4 || !ecmpMask.empty())
+    {
+        return;
+    }
+    ecmpDelay = strcmp(metric, "delay") == 0;
+    buildEcmp();
+}
+
+/**
+ * @description: Compute the equal-cost next hops of every router towards every destination, with one thread
+ *               per core taking destinations in turn. Every thread fills the rows of its destinations in place.
+ * @return {*} None
+ */
+void pfrpTable::buildEcmp()
+{
+    ecmpMask.assign(nodeNum, vector<uint64_t>((adjNode.size() + 63) / 64, 0));
+    vector<long> nextHops(nodeNum, 0);
+    vector<long> multiPaths(nodeNum, 0);
+    atomic<int> nextDestination(0);
+    int threadNum = max(1, min(nodeNum, int(thread::hardware_concurrency())));
+    vector<thread> workers;
+    for (int t = 0; t < threadNum; t++)
+    {
+        workers.emplace_back([&]()
+                             {
+                                 for (int dst = nextDestination++; dst < nodeNum; dst = nextDestination++)
+                                 {
+                                     ecmpDestination(dst, ecmpMask[dst], nextHops[dst], multiPaths[dst]);
+                                 } });
+    }
+    for (thread &worker : workers)
+    {
+        worker.join();
+    }
+
+    long total = accumulate(nextHops.begin(), nextHops.end(), 0L);
+    long multiPath = accumulate(multiPaths.begin(), multiPaths.end(), 0L);
+
+    pfrpTelemetry::getInstance()->log(pfrpTelemetry::LEVEL_INFO, "---- ecmp ---- " + to_string(total) + " next hops by " +
+                                                                     (ecmpDelay ? "delay" : "hop") + ", " + to_string(multiPath) +
+                                                                     " router-destination pairs with equal-cost choices, on " + to_string(threadNum) + " threads");
+}
+
+/**
+ * @description: Compute the equal-cost next hops of every router towards a destination by Dijkstra from the
+ *               destination. Costs are compared as (delay, hops), the delay being 0 with the hop metric, and
+ *               delays within a relative 1e-9 count as equal, since their sums are accumulated in different orders.
+ * @param {int} dstNode                 ID of the destination
+ * @param {vector<uint64_t>} &mask      row of the destination, bit k is set if adjNode[k] is an equal-cost next hop
+ * @param {long} &nextHops              number of equal-cost next hops of all routers
+ * @param {long} &multiPath             number of routers with more than one equal-cost next hop
+ * @return {*} None
+ */
+void pfrpTable::ecmpDestination(int dstNode, vector<uint64_t> &mask, long &nextHops, long &multiPath) const
+{
+    vector<double> delay(nodeNum, HUGE_VAL);
+    vector<int> hops(nodeNum, INT_MAX);
+    priority_queue<pair<pair<double, int>, int>, vector<pair<pair<double, int>, int>>, greater<pair<pair<double, int>, int>>> heap;
+    delay[dstNode] = 0.0;
+    hops[dstNode] = 0;
+    heap.push(make_pair(make_pair(0.0, 0), dstNode));
+    while (!heap.empty())
+    {
+        pair<double, int> d = heap.top().first;
+        int node = heap.top().second;
+        heap.pop();
+        if (d != make_pair(delay[node], hops[node]))
+        {
+            continue;
+        }
+        for (int k = adjStart[node]; k < adjStart[node + 1]; k++)
+        {
+            // the link towards node is the reverse of adjEdge[k]
+            pair<double, int> via(d.first + (ecmpDelay ? linkDelay[adjEdge[k] ^ 1] : 0.0), d.second + 1);
+            int v = adjNode[k];
+            if (via < make_pair(delay[v], hops[v]))
+            {
+                delay[v] = via.first;
+                hops[v] = via.second;
+                heap.push(make_pair(via, v));
+            }
+        }
+    }
+
+    for (int i = 0; i < nodeNum; i++)
+    {
+        if (i == dstNode || hops[i] == INT_MAX)
+        {
+            continue;
+        }
+        int count = 0;
+        for (int k = adjStart[i]; k < adjStart[i + 1]; k++)
+        {
+            int v = adjNode[k];
+            double via = delay[v] + (ecmpDelay ? linkDelay[adjEdge[k]] : 0.0);
+            if (hops[v] + 1 == hops[i] && fabs(via - delay[i]) <= 1e-9 * delay[i])
+            {
+                mask[k >> 6] |= uint64_t(1) << (k & 63);
+                count++;
+            }
+        }
+        nextHops += count;
+        multiPath += count > 1;
+    }
+}
+
+/**
+ * @description: Get the next hop of a packet on the shortest paths towards its destination. Among equal-cost
+ *               next hops the choice is a hash of (src, dst) and the router, so the packets of an OD pair
+ *               always follow one path, and routers do not all make the same choice for the pairs they share.
+ * @param {int} nodeId      ID of current node
+ * @param {int} srcNode     ID of source of current packet
+ * @param {int} dstNode     ID of destination of current packet
+ * @return {int}            ID of the next-hop node
+ */
+int pfrpTable::getEcmpNextNode(int nodeId, int srcNode, int dstNode)
+{
+    if (ecmpMask.empty())
+    {
+        throw cRuntimeError("pfrpTable: the shortest paths of simMode 4 are computed by setShortestPath at initialization");
+    }
+    const uint64_t *mask = ecmpMask[dstNode].data();
+    int begin = adjStart[nodeId];
+    int end = adjStart[nodeId + 1];
+    int count = 0;
+    for (int k = begin; k < end; k++)
+    {
+        count += (mask[k >> 6] >> (k & 63)) & 1;
+    }
+    if (count == 0)
+    {
+        // dstNode is unreachable, the packet is sampled until it expires
+        return getNextNode(nodeId, dstNode);
+    }
+    int choice = 0;
+    if (count > 1)
+    {
+        // splitmix64 finalizer of the OD pair salted with the router
+        uint64_t x = ((uint64_t(srcNode) << 32) | uint32_t(dstNode)) ^ (uint64_t(nodeId) * 0x9E3779B97F4A7C15ull);
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+        x ^= x >> 31;
+        choice = int(x % count);
+    }
+    for (int k = begin;; k++)
+    {
+        if (((mask[k >> 6] >> (k & 63)) & 1) && choice-- == 0)
+        {
+            return adjNode[k];
+        }
+    }
+}
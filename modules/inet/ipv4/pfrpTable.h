@@ -12,13 +12,26 @@
  *                 can be extended to one object per node.
  */
 
+#include "pfrpProbFile.h"
+#include "pfrpRecorder.h"
+#include "pfrpShm.h"
+#include "pfrpTelemetry.h"
+#include "pfrpTiming.h"
 #include "string.h"
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cmath>
+#include <cstdint>
 #include <ctime>
 #include <fstream>
 #include <iostream>
 #include <numeric>
 #include <omnetpp.h>
+#include <queue>
+#include <set>
 #include <string>
+#include <thread>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
@@ -27,12 +40,84 @@
 using namespace std;
 using namespace omnetpp;
 
+/**
+ * Random number stream used by one router to sample next hops.
+ * Each router owns its stream, so sampling takes no lock and does not depend on the order
+ * in which routers draw. Stream i of seed s always produces the same sequence.
+ */
+class pfrpRng
+{
+public:
+  pfrpRng(uint64_t seed = 0, uint64_t stream = 0)
+  {
+    // splitmix64 of the (seed, stream) pair, never zero for xorshift
+    uint64_t z = seed + (stream + 1) * 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    state = (z ^ (z >> 31)) | 1;
+  }
+
+  // Get 32 random bits (xorshift64*).
+  uint32_t next()
+  {
+    state ^= state >> 12;
+    state ^= state << 25;
+    state ^= state >> 27;
+    return uint32_t((state * 0x2545F4914F6CDD1DULL) >> 32);
+  }
+
+  // Get a uniformly distributed integer in [0, n).
+  uint32_t below(uint32_t n)
+  {
+    return uint32_t((uint64_t(next()) * n) >> 32);
+  }
+
+private:
+  uint64_t state;
+};
+
+/**
+ * Next hop a router keeps for a (src, dst) flowlet, valid while the flowlet is not idle for longer than the
+ * flowlet gap and the routing table has not been replaced since it was sampled.
+ */
+struct pfrpFlowlet
+{
+  uint32_t key = UINT32_MAX; // src * nodeNum + dst, UINT32_MAX for an empty slot
+  int nextNode = -1;         // next hop sampled by the first packet of the flowlet
+  uint32_t version = 0;      // tableVersion the next hop was sampled from
+  double lastSeen = 0;       // arrival time of the last packet of the flowlet, in s
+};
+
+// Workspace of the path searches of one thread, parent and dist are -1 outside a search.
+struct pfrpPathSearch
+{
+  vector<int> parent;          // previous router on the best path found so far
+  vector<int> dist;            // hops of the best path found so far
+  vector<vector<int>> buckets; // routers to expand, by estimated path length minus the lower bound of the search
+  vector<int> touched;         // routers whose parent and dist are set
+  vector<uint16_t> estimate;   // hop distances towards the destination of the searches, by one BFS from it
+  vector<int> frontier;        // queue of that BFS
+};
+
 class pfrpTable
 {
+public:
+  // Reasons a router drops a packet for, see countDrop.
+  enum DropReason
+  {
+    DROP_TTL = 0,  // TTL reached zero
+    DROP_SURVIVAL, // survivalTime ran out
+    DROP_EARLY,    // could not arrive within survivalTime any more, counted as DROP_SURVIVAL too
+    DROP_REASON_NUM
+  };
+
 public:
   // Get unique static instance of probabilistic routing table.
   static pfrpTable *getInstance();
 
+  // Whether the unique static instance has been initialized.
+  static bool isInitiated();
+
   // Initialize probabilistic routing table.
   static pfrpTable *initTable(int num, const char *file, int port, double survivalTime_v, int totalStep_v, int simMode_v);
 
@@ -76,14 +161,17 @@ public:
   // Select next hop for current packet based on probabilistic routing table.
   int getNextNode(int nodeId, int dstNode);
 
-  // Convert the initial probabilistic routing table into a probability matrix.
-  int **getProb(string fileName, int **Prob);
+  // Read the initial probabilistic routing table into the CSR adjacency.
+  void getProb(const string &fileName);
+
+  // Check that a router has as many point-to-point links in the network as neighbors in the routing file.
+  void checkDegree(int nodeId, int linkNum);
 
   // Get the ID of the output gate forwarded by the current node to the next node.
   int getGateId(int nodeId, int nextNode);
 
-  // show the details of routing table and network topology
-  void showInfo();
+  // Record the routing table and network topology of a step through the telemetry sink.
+  void showInfo(int step);
 
   // Assign the file path of the initial probabilistic routing table to routingFileName.
   void setRoutingFileName(const char *file);
@@ -115,23 +203,188 @@ public:
   // Get the id of the sending gate.
   int getSendId();
 
+  // Get the topo edge id of the link behind the gateIndex-th point-to-point interface of a router.
+  int getEdgeId(int nodeId, int gateIndex);
+
+  // Seed the next-hop sampling stream of every router from the simulation seed.
+  void setSeed(uint64_t seed);
+
+  // Write one JSON line of per-phase timing counters per step to the given file, if compiled with PFRP_TIMING.
+  void setTimingFile(const char *file);
+
+  // Record the state, action and reward of every step to "<prefix>.pfrd"/"<prefix>.pfri" for offline RL.
+  void setRecordFile(const char *prefix, int chunkSteps);
+
+  // Enable the optional per-link queue occupancy block in the state message.
+  void setQueueState(bool enable);
+
+  // Exchange messages with python through the shared-memory region /dev/shm/<name> instead of ZMQ.
+  void setShmName(const char *name);
+
+  // Split the routers of multi-agent DRL into groups with their own agent endpoints, 0 keeps one REQ socket.
+  void setAgentGroups(int groups);
+
+  // Sample next hops from fixed-point thresholds of 16 or 32 bits instead of integer percentages, 0 keeps percentages.
+  void setProbResolution(int bits);
+
+  // Name nodes as elements of the vector submodules R[] and H[] instead of scalar submodules Ri and Hi.
+  void setVectorNodes(bool enable);
+
+  // Get the ID of a node from its name in a module path, such as R3 or R[3].
+  static int parseNodeId(const char *name);
+
+  // Restrict next hops to neighbors strictly closer to the destination and/or count the hops that are not,
+  // caching the hop distances towards distRows destinations.
+  void setLoopFree(bool restrictHops, bool countHops, int distRows);
+
+  // Keep the next hop of (src, dst) flowlets in a cache of slots entries per router until they idle for gap seconds,
+  // gap 0 samples every packet.
+  void setFlowlet(double gap, int slots);
+
+  // simMode 3: compute the k shortest loop-free paths of every OD pair in parallel and list them in pathFile.
+  void setPathCount(int k, const char *pathFile);
+
+  // simMode 3: sample the index of the path of a packet among the paths of its OD pair.
+  int samplePath(int srcNode, int dstNode);
+
+  // simMode 4: forward on the shortest paths by "hop" or "delay", among equal-cost next hops by a hash of the OD pair.
+  void setShortestPath(const char *metric);
+
+  // Record the propagation delay and datarate of the link behind the gateIndex-th point-to-point interface of a router.
+  void setLinkDelay(int nodeId, int gateIndex, double delay, double datarate);
+
+  // Note that a router drops packets that cannot arrive in time, so that setDelayBound computes the lower bounds.
+  void enableEarlyDrop();
+
+  // Compute the lower bounds of exceedsSurvival once the routers have reported their links.
+  void setDelayBound();
+
+  // Whether a packet at a router can no longer reach its destination router within survivalTime.
+  bool exceedsSurvival(int nodeId, const char *pkName, double age, int64_t bits);
+
+  // Count a packet dropped by a router in the statistics of its step and of the link it was to leave on.
+  void countDrop(int nodeId, int gateIndex, const char *pkName, int reason);
+
+  // Append the drop counts of a step and of every link to the reward message.
+  void setDropStats(bool enable);
+
+  // Record a change of the number of packets waiting in the queue of a router interface.
+  void countQueueLength(int nodeId, int gateIndex, int delta, double currentTime);
+
+  // Record the queueing delay of a packet leaving the queue of a router interface.
+  void countQueueDelay(int nodeId, int gateIndex, double delay);
+
 private:
   static pfrpTable *pTable;
 
 private:
   pfrpTable();
   virtual ~pfrpTable();
-  int **allProb; // Stores the forwarding probability between all nodes, which is updated every step.
-  /**
-   * Store the network topology, denoted as -1 between nodes with no links,
-   * and as the corresponding link number between nodes with links present
-   */
-  int **topo;
+
+  // Send a message to python and block until its reply arrives, the reply stays valid until the next exchange.
+  const char *exchange(const string &reqStr, size_t &replySize);
+
+  // Append the timing counters of the finished step to the timing file and reset them.
+  void writeTimingRecord(int step, double endTime);
+
+  // Send a message of a router to the agent of its group, without waiting for the reply.
+  void sendToGroup(int nodeId, const string &message);
+
+  // Send the local observation of every router to its group, then gather the routing rows.
+  void exchangeGroups(int step);
+
+  // Wait until every router has been answered by its group.
+  void gatherGroupReplies(bool installRows);
+
+  // Install a routing row received from a group.
+  void installGroupRow(const char *data, size_t size);
+
+  // Install the routing row of a router from the dense row of a multi-agent action in rowValue.
+  void installValues(int nodeId);
+
+  // Close the queue sampling interval at the end of a step into queueAvgLen and queueAvgDelay.
+  void closeQueueInterval(double now);
+
+  // Build the CSR adjacency of the topology from the entries of the routing table and number its links.
+  void buildAdjacency(const pfrpProbEntry *entries, size_t entryNum);
+
+  // Find the position in adjNode of the link from a router to a neighbor, -1 if there is none.
+  int findLink(int nodeId, int neighbor) const;
+
+  // Expand values aligned with adjNode into a dense nodeNum x nodeNum matrix.
+  void expandRows(const vector<int> &values, int fillValue, vector<int> &dense) const;
+
+  // Normalize the contiguous neighbor weights of a router into its fixed-point thresholds.
+  void installRow(int nodeId, const double *weights);
+
+  // Turn the link weights of a router into its routing row.
+  void normalizeRow(int nodeId);
+
+  // Apply a sparse update of the routing table and renormalize the rows it touches.
+  void applyDelta(const char *delta);
+
+  // Read a dense comma-separated routing file and check its dimensions.
+  void getProbText(const string &fileName);
+
+  // Read a sparse binary routing file (.pfrb) by mapping it into memory.
+  void getProbBinary(const string &fileName);
+
+  // Get the name of a node that next hops are resolved with.
+  string nodeName(char prefix, int id) const;
+
+  // Compute the hop distance of every router to a destination by BFS over the CSR adjacency.
+  void bfsHops(int dst, uint16_t *dist, vector<int> &frontier) const;
+
+  // Get the hop distances towards a destination from the cache, computing them on a miss.
+  const uint16_t *getHopDist(int dst);
+
+  // Sample a next hop among the neighbors strictly closer to the destination, -1 if there is none.
+  int sampleCloser(int nodeId, int dstNode);
+
+  // Get the next hop of a flowlet from the cache of the router, sampling it on a miss.
+  int getFlowletNextNode(int nodeId, int srcNode, int dstNode);
+
+  // Find a path with the fewest hops avoiding blocked routers and links, by A* search towards search.estimate.
+  bool shortestPath(int from, int to, const vector<char> &nodeBlocked, const vector<char> &edgeBlocked,
+                    pfrpPathSearch &search, vector<int> &path) const;
+
+  // Compute the k shortest loop-free paths in hops from every other router to a router with Yen's algorithm.
+  void yenPaths(int dstNode, int k, vector<vector<vector<int>>> &paths) const;
+
+  // Write the paths of every OD pair to a text file.
+  void writePathFile(const char *pathFile);
+
+  // Get the router after the current one on the path of a packet.
+  int getPathNextNode(int nodeId, int srcNode, int dstNode, int pathIndex);
+
+  // Apply a sparse update of the path split ratios, the body of a "d@@..." reply in simMode 3.
+  void applyPathDelta(const char *delta);
+
+  // Compute the equal-cost next hops of every router towards every destination by one Dijkstra per destination.
+  void buildEcmp();
+
+  // Compute the equal-cost next hops of every router towards one destination as a row of ecmpMask.
+  void ecmpDestination(int dstNode, vector<uint64_t> &mask, long &nextHops, long &multiPath) const;
+
+  // Get the equal-cost next hop of a router chosen by the hash of the OD pair of a packet.
+  int getEcmpNextNode(int nodeId, int srcNode, int dstNode);
+
+  // Compute the lower bounds of the delay from every router to every destination router by Dijkstra.
+  void buildDelayBound();
+
+  // Compute the lower bounds of the delay from every router to one destination router by Dijkstra.
+  void delayBoundDestination(int dstNode);
+
+  // Append the drop blocks of a step to a reward message and reset the per-link counts.
+  void appendDropBlocks(string &reqStr, int step);
+
   int nodeNum = 0;
+  bool vectorNodes = false; // Whether nodes are named R[i] and H[i] instead of Ri and Hi.
   string routingFileName; // Name of the file used to initialize the forwarding probability matrix.
-  int **pkct = NULL;      // Counts the amount of traffic that passes through each link in one step of time, in bytes.
+  vector<int> pkct;       // Counts the amount of traffic that passes through each link in one step of time, in bytes, indexed by topo edge id.
   bool firstTime = true;  // Used to discard the data of the zeroth step.
   int edgeNum = 0;
+  vector<pair<int, int>> edgeEnds; // Routers (i, j), i < j, of every link, indexed by topo edge id / 2.
   vector<vector<double>> delayWithStep;
   int *pkNumOfStep;
   bool *stepIsEnd;
@@ -141,8 +394,109 @@ private:
   int *stepEndRecordCount;
   double survivalTime;
   int totalStep = 0;
-  int *ttlDrop;
-  int *stDrop;
+  int *ttlDrop;   // Packets of each step dropped because their TTL reached zero.
+  int *stDrop;    // Packets of each step dropped for their survivalTime, including early drops.
+  int *earlyDrop; // Packets of each step dropped before their survivalTime because they could not arrive in time.
+  bool dropStats = false; // Whether the drop blocks are appended to the reward message.
+  vector<int> linkDrop;   // Drops since the last reward, at [reason * edgeNum * 2 + topo edge id].
+
+  /**
+   * Lower bound of the delay from router i to router dst, propagation plus transmission of the packet on the
+   * fastest links, stored at [dst * nodeNum + i] as the two separately minimized terms. Links without a
+   * registered delay count as instantaneous, so the bound never exceeds the real delay.
+   */
+  vector<double> linkDelay;   // propagation delay of each topo edge id, unit: s
+  vector<double> linkInvRate; // inverse datarate of each topo edge id, unit: s/bit
+  bool delayBoundUsed = false; // Whether a router drops packets early, setDelayBound builds the bounds if so.
+  vector<float> minPropDelay; // rounded down
+  vector<float> minInvRate;   // rounded down
+
+  // Queue occupancy of the interface feeding each link, indexed by topo edge id.
+  bool queueState = false;      // Whether the queue block is appended to the state message.
+  int *queueLen = NULL;         // Packets currently waiting in the queue.
+  double *queueArea = NULL;     // Integral of queueLen over the current step, unit: packet * s.
+  double *queueLastTime = NULL; // Time of the last change of queueLen.
+  double *queueDelaySum = NULL; // Sum of the queueing delays of packets dequeued in the current step.
+  int *queueDelayCount = NULL;  // Number of packets dequeued in the current step.
+  double queueStepStart = 0.0;  // Start time of the current sampling interval.
+  vector<double> queueAvgLen;   // Time-weighted average queue length of the last closed interval.
+  vector<double> queueAvgDelay; // Average queueing delay of the last closed interval.
+
+  vector<pfrpRng> routerRng; // next-hop sampling stream of each router, stream ID = router ID
+
+  // CSR adjacency, the neighbors of router i are adjNode[adjStart[i] .. adjStart[i + 1]) in ascending ID order,
+  // which is also the order of its point-to-point interfaces.
+  vector<int> adjStart;
+  vector<int> adjNode;
+  vector<int> adjEdge;      // topo edge id of the link to adjNode[k]
+  vector<int> adjProb;      // forwarding probability of the link to adjNode[k], updated every step, see probResolution
+  vector<double> adjWeight; // current weight of the link to adjNode[k], kept across steps for sparse updates
+  vector<int> edgePos;      // position of a topo edge id in adjNode
+  vector<int> edgeSrc;      // router a topo edge id leaves from
+  vector<char> rowDirty;    // rows touched by the sparse update being applied
+
+  /**
+   * Fixed-point next-hop table, aligned with adjNode. Entry k is the inclusive upper bound of the random
+   * draw selecting adjNode[k]; every neighbor keeps at least one LSB. With probResolution 0 the
+   * integer percentages in adjProb are sampled instead, and in fixed-point mode adjProb holds the
+   * probabilities in units of 2^-16 for display and recording.
+   */
+  int probResolution = 0;
+  vector<uint16_t> probThreshold16;
+  vector<uint32_t> probThreshold32;
+  vector<double> rowValue; // parsed row of a multi-agent action
+  vector<uint64_t> rowWidth;
+
+  /**
+   * Per-destination loop-free next hops. A neighbor is a progress hop if it is strictly closer to the destination
+   * in hops, so restricted forwarding follows a DAG towards every destination and cannot loop. The weights of the
+   * table are renormalized over that set. The hop distances towards dst are computed by one BFS when a packet
+   * first needs them and kept in the direct-mapped slot dst % hopDistSlots, nodeNum entries per slot.
+   */
+  bool loopFree = false;         // Whether next hops are restricted to progress hops.
+  bool detourStats = false;      // Whether non-progress hops are counted.
+  int hopDistSlots = 0;          // Destinations whose hop distances are cached, at most nodeNum.
+  vector<uint16_t> hopDistCache; // Hop distances of the cached destinations, slot-major.
+  vector<int> hopDistOwner;      // Destination held by every slot, -1 if none.
+  vector<int> hopDistFrontier;   // BFS queue of the cache.
+  int nonProgressHops = 0;       // Router-to-router hops of the current step that do not get closer.
+  int routedHops = 0;            // Router-to-router hops of the current step.
+  vector<int> nonProgressOfStep; // nonProgressHops of every finished step
+  vector<int> routedOfStep;      // routedHops of every finished step
+
+  /**
+   * Per-router direct-mapped flowlet cache, slot h of router i is flowletCache[i << flowletBits | h]. A flowlet
+   * keeps its next hop while its packets are less than flowletGap apart and no new table has been installed,
+   * so packets of a flow are not reordered and the split of the table holds per flowlet.
+   */
+  double flowletGap = 0;             // Idle time that ends a flowlet in s, 0 disables the cache.
+  int flowletBits = 0;               // log2 of the slots per router.
+  vector<pfrpFlowlet> flowletCache;  // Built when flowletGap > 0.
+  uint32_t tableVersion = 0;         // Incremented whenever updateProb installs a new table.
+  long flowletHits = 0;              // Next hops of the current step taken from the cache.
+  long flowletLookups = 0;           // Next hops of the current step looked up in the cache.
+
+  /**
+   * simMode 3, the k shortest loop-free paths of every OD pair. The paths of (s, d) have the ids
+   * odPathStart[s * nodeNum + d] .. odPathStart[s * nodeNum + d + 1] - 1 in ascending hop count, path p
+   * visits the routers pathNodes[pathNodeStart[p] .. pathNodeStart[p + 1]) from s to d, and its share of
+   * the traffic of the pair is pathWeight[p] over the sum of the weights of the pair.
+   */
+  int pathCount = 0;          // k, 0 until the paths are computed.
+  vector<int> odPathStart;    // First path id of every OD pair, nodeNum * nodeNum + 1 entries.
+  vector<int> pathNodeStart;  // First position of every path in pathNodes, pathNum + 1 entries.
+  vector<int> pathNodes;      // Routers of all paths.
+  vector<double> pathWeight;  // Split weight of every path, the action of the agent.
+
+  /**
+   * simMode 4, deterministic shortest-path forwarding. Paths are compared by (propagation delay, hops) with
+   * the delay metric and by hops with the hop metric, so every equal-cost next hop is one hop closer and
+   * forwarding cannot loop. Every next hop is a neighbor, so the row of dst is a bit set over the CSR
+   * adjacency: adjNode[k] is an equal-cost next hop of edgeSrc[k] towards dst if bit k of ecmpMask[dst] is set,
+   * one bit per directed link and destination instead of an offset per router and destination.
+   */
+  bool ecmpDelay = false;              // Whether the propagation delay is the primary cost.
+  vector<vector<uint64_t>> ecmpMask;   // One row per destination, built by setShortestPath.
 
   vector<vector<unordered_set<int> *>> pktInNode;
   vector<unordered_map<int, double> *> pktDelay;
@@ -151,6 +505,20 @@ private:
   int sendId = 0;  // ID used to identify the package, each package has a unique ID
   int simMode;
   int zmqPort;
+  pfrpTimingCounters timing; // per-phase counters, only updated when compiled with PFRP_TIMING
+  ofstream timingStream;      // JSON lines file the timing records are written to
+  int64_t timingRecordStart = 0;
+  vector<double> recordRow;       // reused row buffer of the recorder
+  bool topoSnapshotTaken = false; // the topology is snapshotted once, with the first sampled step
+  vector<int> denseRow;           // dense matrix of the recorded and snapshotted steps, reused
+
   zmq::context_t zmqContext{1};
   zmq::socket_t zmqSocket{zmqContext, ZMQ_REQ};
+  zmq::message_t zmqReply; // last reply received over ZMQ
+  pfrpShmChannel shm;      // used instead of zmqSocket when mapped
+
+  // Multi-agent endpoints, router i belongs to group i * agentGroups / nodeNum.
+  int agentGroups = 0;
+  vector<zmq::socket_t *> groupSockets;
+  string groupReply; // NUL-terminated copy of the reply being parsed
 };
\ No newline at end of file
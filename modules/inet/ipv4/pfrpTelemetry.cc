@@ -0,0 +1,198 @@
+/*
+ * @Date         : 2026-10-19 13:00:00
+ * @FilePath     : RL4Net++/modules/inet/ipv4/pfrpTelemetry.cc
+ * @Description  : Leveled telemetry sink with a background writer thread and a lock-free ring.
+ */
+#include "pfrpTelemetry.h"
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+
+/**
+ * @description: Get unique static instance of the telemetry sink.
+ *               The instance is destroyed at exit, which drains the ring and joins the writer.
+ * @return {*pfrpTelemetry} telemetry sink
+ */
+pfrpTelemetry *pfrpTelemetry::getInstance()
+{
+    static pfrpTelemetry instance;
+    return &instance;
+}
+
+pfrpTelemetry::~pfrpTelemetry()
+{
+    stop();
+    if (dropped > 0)
+        fprintf(stderr, "pfrpTelemetry: %ld records dropped\n", dropped.load());
+}
+
+/**
+ * @description: Set the log level and the destinations. Only the first call takes effect,
+ *               every application instance passes the same parameters. A writer started by
+ *               a record queued before this call is drained and restarted on the new destinations.
+ * @param {int} level               highest level written, see Level
+ * @param {char} *logFile           file the log lines are written to, empty for stdout
+ * @param {char} *snapshotFile      file the binary matrix snapshots are written to, empty to disable
+ * @param {int} interval            a snapshot is taken every interval steps, 0 to disable
+ * @return {*} None
+ */
+void pfrpTelemetry::configure(int level, const char *logFile, const char *snapshotFile, int interval)
+{
+    if (configured)
+    {
+        return;
+    }
+    configured = true;
+    stop();
+    logLevel = level;
+    logPath = logFile ? logFile : "";
+    snapshotPath = snapshotFile ? snapshotFile : "";
+    snapshotInterval = interval;
+    start();
+}
+
+/**
+ * @description: Open the destinations and start the writer thread on first use.
+ * @return {*} None
+ */
+void pfrpTelemetry::start()
+{
+    if (running)
+    {
+        return;
+    }
+    logOut = logPath.empty() ? stdout : fopen(logPath.c_str(), "w");
+    if (!logOut)
+        logOut = stdout;
+    if (!snapshotPath.empty())
+        snapshotOut = fopen(snapshotPath.c_str(), "wb");
+    running = true;
+    writer = thread(&pfrpTelemetry::writerLoop, this);
+}
+
+/**
+ * @description: Stop the writer thread once the ring is drained and close the destinations.
+ * @return {*} None
+ */
+void pfrpTelemetry::stop()
+{
+    if (!running)
+    {
+        return;
+    }
+    running = false;
+    writer.join();
+    if (logOut && logOut != stdout)
+        fclose(logOut);
+    if (snapshotOut)
+        fclose(snapshotOut);
+    logOut = NULL;
+    snapshotOut = NULL;
+}
+
+/**
+ * @description: Queue a log line of the given level.
+ * @param {int} level       level of the line
+ * @param {string} &text    the line, without trailing newline
+ * @return {*} None
+ */
+void pfrpTelemetry::log(int level, const string &text)
+{
+    if (!isEnabled(level))
+    {
+        return;
+    }
+    push(new Record{false, text});
+}
+
+/**
+ * @description: Queue a binary snapshot of a nodeNum x nodeNum matrix.
+ * @param {int} step        step the matrix belongs to
+ * @param {int} kind        content of the matrix, see SnapshotKind
+ * @param {int} *matrix     the matrix, row-major
+ * @param {int} nodeNum     number of rows and columns
+ * @return {*} None
+ */
+void pfrpTelemetry::snapshot(int step, int kind, const int *matrix, int nodeNum)
+{
+    if (snapshotPath.empty())
+    {
+        return;
+    }
+    int32_t header[3] = {step, kind, nodeNum};
+    Record *record = new Record{true, string()};
+    record->data.resize(4 + sizeof(header) + size_t(nodeNum) * nodeNum * sizeof(int32_t));
+    char *out = &record->data[0];
+    memcpy(out, "PFSN", 4);
+    memcpy(out + 4, header, sizeof(header));
+    memcpy(out + 4 + sizeof(header), matrix, size_t(nodeNum) * nodeNum * sizeof(int32_t));
+    push(record);
+}
+
+/**
+ * @description: Move a record into the ring, dropping it if the writer has fallen behind.
+ *               Only the simulation thread pushes, so head needs no compare-and-swap.
+ * @param {Record} *record  record owned by the ring from now on
+ * @return {*} None
+ */
+void pfrpTelemetry::push(Record *record)
+{
+    start();
+    size_t h = head.load(memory_order_relaxed);
+    if (h - tail.load(memory_order_acquire) >= ringSize)
+    {
+        dropped++;
+        delete record;
+        return;
+    }
+    ring[h & (ringSize - 1)] = record;
+    head.store(h + 1, memory_order_release);
+}
+
+/**
+ * @description: Block until every queued record has been written.
+ * @return {*} None
+ */
+void pfrpTelemetry::flush()
+{
+    while (running && tail.load(memory_order_acquire) != head.load(memory_order_acquire))
+        this_thread::sleep_for(chrono::microseconds(100));
+}
+
+/**
+ * @description: Body of the background writer thread, writes records until stopped and the ring is empty.
+ * @return {*} None
+ */
+void pfrpTelemetry::writerLoop()
+{
+    while (true)
+    {
+        size_t t = tail.load(memory_order_relaxed);
+        if (t == head.load(memory_order_acquire))
+        {
+            if (!running)
+                break;
+            fflush(logOut);
+            if (snapshotOut)
+                fflush(snapshotOut);
+            this_thread::sleep_for(chrono::microseconds(200));
+            continue;
+        }
+        Record *record = ring[t & (ringSize - 1)];
+        if (record->binary)
+        {
+            if (snapshotOut)
+                fwrite(record->data.data(), 1, record->data.size(), snapshotOut);
+        }
+        else
+        {
+            fwrite(record->data.data(), 1, record->data.size(), logOut);
+            fputc('\n', logOut);
+        }
+        delete record;
+        tail.store(t + 1, memory_order_release);
+    }
+    fflush(logOut);
+    if (snapshotOut)
+        fflush(snapshotOut);
+}
@@ -0,0 +1,101 @@
+/***
+ * @Date         : 2026-10-19 13:00:00
+ * @FilePath     : RL4Net++/modules/inet/ipv4/pfrpTelemetry.h
+ * @Description  : Leveled telemetry sink of the pfrp modules. The simulation thread only moves records into
+ *                 a lock-free single-producer ring, a background thread does all file and terminal I/O.
+ *                 Routing matrices are written as sampled binary snapshots instead of text dumps.
+ *
+ *                 Snapshot file layout, one entry per snapshot, little endian:
+ *                   char[4] magic "PFSN", int32 step, int32 kind (0: allProb, 1: topo), int32 nodeNum,
+ *                   int32[nodeNum * nodeNum] row-major matrix
+ */
+
+#ifndef __PFRP_TELEMETRY_H
+#define __PFRP_TELEMETRY_H
+
+#include <atomic>
+#include <cstdio>
+#include <string>
+#include <thread>
+
+using namespace std;
+
+class pfrpTelemetry
+{
+public:
+  enum Level
+  {
+    LEVEL_ERROR = 0,
+    LEVEL_WARN,
+    LEVEL_INFO,
+    LEVEL_DEBUG
+  };
+
+  enum SnapshotKind
+  {
+    SNAPSHOT_ALLPROB = 0,
+    SNAPSHOT_TOPO
+  };
+
+  // Get unique static instance of the telemetry sink.
+  static pfrpTelemetry *getInstance();
+
+  // Set the log level and the destinations, an empty log file means stdout, an empty snapshot file disables snapshots.
+  void configure(int level, const char *logFile, const char *snapshotFile, int snapshotInterval);
+
+  // Whether messages of the given level are written, check it before building an expensive message.
+  bool isEnabled(int level) const { return level <= logLevel; }
+
+  // Whether the routing matrices of the given step are sampled.
+  bool isSnapshotStep(int step) const { return snapshotInterval > 0 && snapshotPath.size() && step % snapshotInterval == 0; }
+
+  // Queue a log line of the given level.
+  void log(int level, const string &text);
+
+  // Queue a binary snapshot of a nodeNum x nodeNum matrix.
+  void snapshot(int step, int kind, const int *matrix, int nodeNum);
+
+  // Block until every queued record has been written.
+  void flush();
+
+  ~pfrpTelemetry();
+
+private:
+  struct Record
+  {
+    bool binary;
+    string data;
+  };
+
+  pfrpTelemetry() {}
+
+  // Move a record into the ring, dropping it if the writer has fallen behind.
+  void push(Record *record);
+
+  // Body of the background writer thread.
+  void writerLoop();
+
+  // Start the writer thread on first use.
+  void start();
+
+  // Stop the writer thread once the ring is drained and close the destinations.
+  void stop();
+
+  static const size_t ringSize = 8192; // must be a power of two
+  Record *ring[ringSize];
+  atomic<size_t> head{0}; // next slot written by the simulation thread
+  atomic<size_t> tail{0}; // next slot read by the writer thread
+  atomic<bool> running{false};
+  bool configured = false; // configure has been called, later calls are ignored
+  atomic<long> dropped{0}; // records dropped because the ring was full
+  thread writer;
+
+  int logLevel = LEVEL_INFO;
+  int snapshotInterval = 0;
+  string logPath;
+  string snapshotPath;
+  FILE *logOut = NULL;
+  FILE *snapshotOut = NULL;
+};
+
+#endif // __PFRP_TELEMETRY_H
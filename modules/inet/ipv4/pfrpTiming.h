@@ -0,0 +1,66 @@
+/***
+ * @Date         : 2026-10-19 12:00:00
+ * @FilePath     : RL4Net++/modules/inet/ipv4/pfrpTiming.h
+ * @Description  : Per-step timing counters of pfrpTable. The counters are compiled in only when PFRP_TIMING
+ *                 is defined (e.g. PFRP_DEFINES=-DPFRP_TIMING in modules/inet/Makefile), otherwise the macros
+ *                 expand to nothing and cost nothing.
+ */
+
+#ifndef __PFRP_TIMING_H
+#define __PFRP_TIMING_H
+
+#include <chrono>
+#include <cstdint>
+
+// Phases of a step whose wall-clock time is measured.
+enum pfrpPhase
+{
+  PHASE_FORWARD = 0, // next-hop selection in getRoute
+  PHASE_STATE,       // serializing the state and installing the action in updateProb
+  PHASE_ZMQ_WAIT,    // blocking exchange with python in updateProb, endStep and endStepMulti
+  PHASE_REWARD,      // reward aggregation in endStep and endStepMulti
+  PHASE_SHOW_INFO,   // queueing the step info and snapshots in showInfo
+  PHASE_NUM
+};
+
+static const char *const pfrpPhaseNames[PHASE_NUM] = {"forward", "state", "zmqWait", "reward", "showInfo"};
+
+// Accumulated time and number of calls of every phase since the last record.
+struct pfrpTimingCounters
+{
+  int64_t ns[PHASE_NUM] = {0};
+  int64_t calls[PHASE_NUM] = {0};
+  int64_t start[PHASE_NUM] = {0};
+
+  static int64_t now()
+  {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+  }
+
+  void begin(pfrpPhase phase) { start[phase] = now(); }
+
+  void end(pfrpPhase phase)
+  {
+    ns[phase] += now() - start[phase];
+    calls[phase]++;
+  }
+
+  void reset()
+  {
+    for (int i = 0; i < PHASE_NUM; i++)
+    {
+      ns[i] = 0;
+      calls[i] = 0;
+    }
+  }
+};
+
+#ifdef PFRP_TIMING
+#define PFRP_TIMING_BEGIN(phase) timing.begin(phase)
+#define PFRP_TIMING_END(phase) timing.end(phase)
+#else
+#define PFRP_TIMING_BEGIN(phase)
+#define PFRP_TIMING_END(phase)
+#endif
+
+#endif // __PFRP_TIMING_H
@@ -0,0 +1,189 @@
+/*
+ * @Date         : 2026-10-19 18:30:00
+ * @FilePath     : RL4Net++/modules/inet/node/PfrpNedFunctions.cc
+ * @Description  : NED functions that read the links of a topology from its initial routing probability file,
+ *                 so that a network of R[nodeNum] vector submodules connects its routers in a loop:
+ *                     for k=0..pfrpEdgeCount(edgeFile)-1 {
+ *                         R[pfrpEdgeSrc(edgeFile, k)].pppg++ <--> C <--> R[pfrpEdgeDst(edgeFile, k)].pppg++;
+ *                     }
+ *                 Link k is the k-th nonzero entry of the upper triangle in row-major order, the numbering of
+ *                 pfrpTable, so every router connects its neighbors in ascending ID order. Files ending with
+ *                 .pfrb are read as sparse binary routing files, see pfrpProbFile.h. If the network has a
+ *                 nodeNum parameter, the file must have as many nodes, as pfrpTable checks.
+ *                 pfrpNodeDouble reads a parameter of another module of the same network node, so that a
+ *                 parameter such as survivalTime is set once per node:
+ *                     volatile double survivalTime = default(pfrpNodeDouble("ipv4.ip", "survivalTime"));
+ *                 It must be volatile, the other module may not exist yet when the parameters are finalized.
+ */
+#include "inet/networklayer/ipv4/pfrpProbFile.h"
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <omnetpp.h>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace omnetpp;
+
+/**
+ * @description: Read the links of a sparse binary routing file, whose entries are sorted by (src, dst).
+ * @param {string} &fileName                path of the .pfrb file
+ * @param {int} nodeNum                     number of nodes the file must have, -1 for any
+ * @param {vector<pair<int, int>>} &edges   links (i, j) with i < j, in pfrpTable order
+ * @return {*} None
+ */
+static void readBinaryEdges(const string &fileName, int nodeNum, vector<pair<int, int>> &edges)
+{
+    ifstream file(fileName, ios::binary);
+    pfrpProbHeader header;
+    if (!file.read((char *)&header, sizeof(header)) || memcmp(header.magic, "PFRB", 4) != 0 || header.version != 1)
+    {
+        throw cRuntimeError("pfrp NED functions: %s is not a binary routing file", fileName.c_str());
+    }
+    if (nodeNum >= 0 && header.nodeNum != uint32_t(nodeNum))
+    {
+        throw cRuntimeError("pfrp NED functions: %s has %u nodes, nodeNum is %d", fileName.c_str(), header.nodeNum, nodeNum);
+    }
+    vector<pfrpProbEntry> entries(header.entryNum);
+    if (!file.read((char *)entries.data(), entries.size() * sizeof(pfrpProbEntry)))
+    {
+        throw cRuntimeError("pfrp NED functions: %s is truncated", fileName.c_str());
+    }
+    for (const pfrpProbEntry &e : entries)
+    {
+        if (e.src < 0 || uint32_t(e.src) >= header.nodeNum || e.dst < 0 || uint32_t(e.dst) >= header.nodeNum)
+        {
+            throw cRuntimeError("pfrp NED functions: %s has an invalid entry %d,%d,%d", fileName.c_str(), e.src, e.dst, e.prob);
+        }
+        if (e.src < e.dst)
+        {
+            edges.push_back(make_pair(int(e.src), int(e.dst)));
+        }
+    }
+}
+
+/**
+ * @description: Get the links of a probability file, parsed once per file.
+ * @param {string} &fileName    path of the comma-separated nodeNum x nodeNum probability file or of a .pfrb file
+ * @param {cComponent} *context network whose connections are built, checked against its nodeNum parameter if any
+ * @return {vector<pair<int, int>>}  links (i, j) with i < j, in pfrpTable order
+ */
+static const vector<pair<int, int>> &getFileEdges(const string &fileName, cComponent *context)
+{
+    static map<string, vector<pair<int, int>>> cache;
+    auto it = cache.find(fileName);
+    if (it != cache.end())
+    {
+        return it->second;
+    }
+
+    ifstream file(fileName);
+    if (!file)
+    {
+        throw cRuntimeError("pfrp NED functions: cannot open %s", fileName.c_str());
+    }
+    int expectedNum = (context && context->hasPar("nodeNum")) ? int(context->par("nodeNum").intValue()) : -1;
+    if (fileName.size() > 5 && fileName.compare(fileName.size() - 5, 5, ".pfrb") == 0)
+    {
+        vector<pair<int, int>> edges;
+        readBinaryEdges(fileName, expectedNum, edges);
+        return cache[fileName] = edges;
+    }
+    vector<int> values;
+    string value;
+    while (getline(file, value, ','))
+    {
+        values.push_back(atoi(value.c_str()));
+    }
+    int nodeNum = int(lround(sqrt(double(values.size()))));
+    if (size_t(nodeNum) * nodeNum != values.size())
+    {
+        throw cRuntimeError("pfrp NED functions: %s has %zu values, not nodeNum x nodeNum", fileName.c_str(), values.size());
+    }
+    if (expectedNum >= 0 && nodeNum != expectedNum)
+    {
+        throw cRuntimeError("pfrp NED functions: %s has %d nodes, nodeNum is %d", fileName.c_str(), nodeNum, expectedNum);
+    }
+
+    vector<pair<int, int>> &edges = cache[fileName];
+    for (int i = 0; i < nodeNum; i++)
+    {
+        for (int j = i; j < nodeNum; j++)
+        {
+            if (values[size_t(i) * nodeNum + j])
+            {
+                edges.push_back(make_pair(i, j));
+            }
+        }
+    }
+    return edges;
+}
+
+/**
+ * @description: Get a link of a probability file, checked against the number of links.
+ * @param {cComponent} *context network whose connections are built
+ * @param {cNEDValue} argv[]    file name and link index
+ * @return {pair<int, int>}     the link
+ */
+static const pair<int, int> &getFileEdge(cComponent *context, cNEDValue argv[])
+{
+    const vector<pair<int, int>> &edges = getFileEdges(argv[0].stdstringValue(), context);
+    intpar_t k = argv[1].intValue();
+    if (k < 0 || k >= intpar_t(edges.size()))
+    {
+        throw cRuntimeError("pfrp NED functions: link %lld out of range, %s has %zu links", (long long)k, argv[0].stringValue(), edges.size());
+    }
+    return edges[k];
+}
+
+static cNEDValue pfrpEdgeCount(cComponent *context, cNEDValue argv[], int argc)
+{
+    return cNEDValue(intpar_t(getFileEdges(argv[0].stdstringValue(), context).size()));
+}
+
+static cNEDValue pfrpEdgeSrc(cComponent *context, cNEDValue argv[], int argc)
+{
+    return cNEDValue(intpar_t(getFileEdge(context, argv).first));
+}
+
+static cNEDValue pfrpEdgeDst(cComponent *context, cNEDValue argv[], int argc)
+{
+    return cNEDValue(intpar_t(getFileEdge(context, argv).second));
+}
+
+/**
+ * @description: Read a double parameter of a module of the network node that contains the context module.
+ * @param {cComponent} *context     module whose parameter is evaluated
+ * @param {cNEDValue} argv[]        path of the module relative to the node, such as "ipv4.ip", and the parameter name
+ * @param {int} argc                number of arguments
+ * @return {cNEDValue}              value of the parameter
+ */
+static cNEDValue pfrpNodeDouble(cComponent *context, cNEDValue argv[], int argc)
+{
+    cModule *node = dynamic_cast<cModule *>(context);
+    while (node != nullptr && !node->getProperties()->getAsBool("networkNode"))
+    {
+        node = node->getParentModule();
+    }
+    if (node == nullptr)
+    {
+        throw cRuntimeError("pfrp NED functions: %s is not inside a network node", context->getFullPath().c_str());
+    }
+    cModule *module = node->getModuleByPath(("." + argv[0].stdstringValue()).c_str());
+    if (module == nullptr)
+    {
+        throw cRuntimeError("pfrp NED functions: %s has no module %s", node->getFullPath().c_str(), argv[0].stringValue());
+    }
+    return cNEDValue(module->par(argv[1].stringValue()).doubleValue());
+}
+
+Define_NED_Function2(pfrpEdgeCount, "int pfrpEdgeCount(string edgeFile)", "pfrp",
+                     "Number of links of an initial routing probability file");
+Define_NED_Function2(pfrpEdgeSrc, "int pfrpEdgeSrc(string edgeFile, int k)", "pfrp",
+                     "Lower router ID of the k-th link of an initial routing probability file");
+Define_NED_Function2(pfrpEdgeDst, "int pfrpEdgeDst(string edgeFile, int k)", "pfrp",
+                     "Higher router ID of the k-th link of an initial routing probability file");
+Define_NED_Function2(pfrpNodeDouble, "double pfrpNodeDouble(string module, string name)", "pfrp",
+                     "Double parameter of a module of the network node, given by its path relative to the node");
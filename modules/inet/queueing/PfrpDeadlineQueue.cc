@@ -0,0 +1,104 @@
+/***
+ * @Date         : 2026-10-19 22:00:00
+ * @FilePath     : RL4Net++/modules/inet/queueing/PfrpDeadlineQueue.cc
+ * @Description  : Earliest-deadline-first interface queue that drops expired packets at their deadline.
+ */
+
+#include "inet/queueing/queue/PfrpDeadlineQueue.h"
+
+#include "inet/common/ModuleAccess.h"
+#include "inet/common/Simsignals.h"
+#include "inet/networklayer/ipv4/pfrpTable.h"
+
+namespace inet {
+namespace queueing {
+
+Register_Class(PfrpDeadlineComparator);
+
+Define_Module(PfrpDeadlineQueue);
+
+int PfrpDeadlineComparator::comparePackets(Packet *packet1, Packet *packet2) const
+{
+    // cQueue inserts before the first packet that compares greater, so equal times stay FIFO
+    simtime_t creation1 = packet1->getCreationTime();
+    simtime_t creation2 = packet2->getCreationTime();
+    return creation1 < creation2 ? -1 : creation1 > creation2 ? 1 : 0;
+}
+
+void PfrpDeadlineQueue::initialize(int stage)
+{
+    PacketQueue::initialize(stage);
+    if (stage == INITSTAGE_LOCAL) {
+        survivalTime = par("survivalTime").doubleValue();
+        expiryTimer = new cMessage("ExpiryTimer");
+        // drops are counted like the survivalTime drops of Ipv4, by router and by outgoing ppp interface
+        cModule *node = findContainingNode(this);
+        if (node != nullptr && node->getName()[0] == 'R')
+            pfrpNodeId = pfrpTable::parseNodeId(node->getFullName());
+        cModule *nic = getParentModule();
+        if (nic != nullptr && nic->isName("ppp"))
+            pppIndex = nic->getIndex();
+        WATCH(numExpired);
+    }
+}
+
+void PfrpDeadlineQueue::handleMessage(cMessage *message)
+{
+    if (message == expiryTimer) {
+        dropExpiredPackets();
+        updateExpiryTimer();
+        updateDisplayString();
+    }
+    else
+        PacketQueue::handleMessage(message);
+}
+
+void PfrpDeadlineQueue::dropExpiredPackets()
+{
+    // the front packet has the earliest deadline, so the expired packets are a prefix of the queue
+    while (!queue.isEmpty() && getDeadline(check_and_cast<Packet *>(queue.front())) <= simTime()) {
+        Packet *packet = check_and_cast<Packet *>(queue.pop());
+        EV_INFO << "Dropping packet " << packet->getName() << " whose survivalTime ran out in the queue.\n";
+        if (buffer != nullptr)
+            buffer->removePacket(packet);
+        const char *pktName = packet->getFullName();
+        if (strstr(pktName, "pfrp") && pfrpTable::isInitiated())
+            pfrpTable::getInstance()->countDrop(pfrpNodeId, pppIndex, pktName, pfrpTable::DROP_SURVIVAL);
+        numExpired++;
+        dropPacket(packet, HOP_LIMIT_REACHED);
+    }
+}
+
+void PfrpDeadlineQueue::updateExpiryTimer()
+{
+    if (queue.isEmpty()) {
+        cancelEvent(expiryTimer);
+        return;
+    }
+    simtime_t deadline = std::max(simTime(), getDeadline(check_and_cast<Packet *>(queue.front())));
+    if (expiryTimer->isScheduled() && expiryTimer->getArrivalTime() == deadline)
+        return;
+    cancelEvent(expiryTimer);
+    scheduleAt(deadline, expiryTimer);
+}
+
+Packet *PfrpDeadlineQueue::popPacket(cGate *gate)
+{
+    Enter_Method("popPacket");
+    // expired packets have already been dropped by the timer, unless it is due at this very time
+    Packet *packet = PacketQueue::popPacket(gate);
+    updateExpiryTimer();
+    return packet;
+}
+
+void PfrpDeadlineQueue::pushPacket(Packet *packet, cGate *gate)
+{
+    Enter_Method("pushPacket");
+    // make room with the expired packets before the dropper has to choose a live one
+    dropExpiredPackets();
+    PacketQueue::pushPacket(packet, gate);
+    updateExpiryTimer();
+}
+
+} // namespace queueing
+} // namespace inet
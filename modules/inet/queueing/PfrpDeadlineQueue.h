@@ -0,0 +1,61 @@
+/***
+ * @Date         : 2026-10-19 22:00:00
+ * @FilePath     : RL4Net++/modules/inet/queueing/PfrpDeadlineQueue.h
+ * @Description  : Earliest-deadline-first interface queue. Every packet must arrive within survivalTime of its
+ *                 creation, so the packet with the earliest deadline is the oldest one: packets are kept in
+ *                 ascending creation time, FIFO among equal times, and sent in that order. Packets whose
+ *                 survivalTime has run out are dropped by a timer at the deadline of the front packet and before
+ *                 an arriving packet is stored, instead of being sent to be dropped by the next router. The
+ *                 queue holds at most packetCapacity packets, further packets are dropped by dropperClass.
+ */
+
+#ifndef __INET_PFRPDEADLINEQUEUE_H
+#define __INET_PFRPDEADLINEQUEUE_H
+
+#include "inet/queueing/contract/IPacketComparatorFunction.h"
+#include "inet/queueing/queue/PacketQueue.h"
+
+namespace inet {
+namespace queueing {
+
+// Order packets by ascending creation time, that is by ascending deadline, used as comparatorClass.
+class INET_API PfrpDeadlineComparator : public cObject, public virtual IPacketComparatorFunction
+{
+  public:
+    virtual int comparePackets(Packet *packet1, Packet *packet2) const override;
+};
+
+class INET_API PfrpDeadlineQueue : public PacketQueue
+{
+  protected:
+    simtime_t survivalTime;            // of the Ipv4 module of the node
+    int pfrpNodeId = -1;               // ID of the router in pfrpTable, -1 for hosts
+    int pppIndex = -1;                 // index of the ppp interface of the queue, -1 for other interfaces
+    cMessage *expiryTimer = nullptr;   // scheduled at the deadline of the front packet
+    int numExpired = 0;
+
+  protected:
+    virtual void initialize(int stage) override;
+    virtual void handleMessage(cMessage *message) override;
+
+    // Time at which the survivalTime of a packet runs out.
+    simtime_t getDeadline(const Packet *packet) const { return packet->getCreationTime() + survivalTime; }
+
+    // Drop the expired packets at the front of the queue and count them in pfrpTable.
+    void dropExpiredPackets();
+
+    // Schedule the expiry timer at the deadline of the front packet, or cancel it if the queue is empty.
+    void updateExpiryTimer();
+
+  public:
+    virtual ~PfrpDeadlineQueue() { cancelAndDelete(expiryTimer); }
+
+    virtual Packet *popPacket(cGate *gate) override;
+
+    virtual void pushPacket(Packet *packet, cGate *gate) override;
+};
+
+} // namespace queueing
+} // namespace inet
+
+#endif // ifndef __INET_PFRPDEADLINEQUEUE_H
@@ -17,20 +17,21 @@
 //
 
 #include "inet/applications/udpapp/UdpPfrpApp.h"
+#include "inet/applications/base/ApplicationPacketSerializer.h"
 #include "inet/applications/base/ApplicationPacket_m.h"
+#include "inet/applications/udpapp/UdpPfrpPool.h"
 #include "inet/common/ModuleAccess.h"
 #include "inet/common/TagBase_m.h"
 #include "inet/common/TimeTag_m.h"
 #include "inet/common/lifecycle/ModuleOperations.h"
 #include "inet/common/packet/Packet.h"
+#include "inet/common/packet/serializer/ChunkSerializerRegistry.h"
 #include "inet/networklayer/common/FragmentationTag_m.h"
 #include "inet/networklayer/common/L3AddressResolver.h"
 #include "inet/networklayer/ipv4/pfrpTable.h"
 #include "inet/transportlayer/contract/udp/UdpControlInfo_m.h"
 #include "unistd.h"
-#include <chrono>
 #include <iostream>
-#include <random>
 #include <unordered_map>
 
 using namespace std;
@@ -40,6 +41,9 @@ namespace inet
 
     Define_Module(UdpPfrpApp);
 
+    // pooled payloads are serialized like the plain ones
+    Register_Serializer(UdpPfrpPayload, ApplicationPacketSerializer);
+
     UdpPfrpApp::~UdpPfrpApp()
     {
         cancelAndDelete(selfMsg);
@@ -61,6 +65,7 @@ namespace inet
             zmqPort = par("zmqPort");
             routingFileName = par("routingFileName");
             messageLength = par("messageLength");
+            packetPool = par("packetPool");
             flowRate = par("flowRate");
             sendInterval = 1 / (flowRate * 1024 * 1024 / 8 / messageLength);
             survivalTime = par("survivalTime");
@@ -78,8 +83,35 @@ namespace inet
             {
                 routingProtocol = "pfrpma";
             }
+            else if (simMode == 3)
+            {
+                routingProtocol = "pfrpkp";
+            }
+            else if (simMode == 4)
+            {
+                routingProtocol = "pfrpsp";
+            }
 
+            // nodes are either scalar submodules Hi/Ri or elements of the vectors H[]/R[]
+            vectorNode = getParentModule()->isVector();
+            nodeIndex = pfrpTable::parseNodeId(getParentModule()->getFullName());
+
+            // before the pfrpTable setters, which may log
+            pfrpTelemetry::getInstance()->configure(par("telemetryLevel"), par("telemetryFile"), par("snapshotFile"), par("snapshotInterval"));
             pfrpTable::initTable(nodeNum, routingFileName, zmqPort, survivalTime, totalStep, simMode);
+            pfrpTable::getInstance()->setVectorNodes(vectorNode);
+            pfrpTable::getInstance()->setSeed(getRunSeed());
+            pfrpTable::getInstance()->setShmName(par("shmName"));
+            pfrpTable::getInstance()->setAgentGroups(par("agentGroups"));
+            queueState = par("queueState");
+            pfrpTable::getInstance()->setQueueState(queueState);
+            pfrpTable::getInstance()->setProbResolution(par("probResolution"));
+            pfrpTable::getInstance()->setLoopFree(par("loopFree"), par("detourStats"), par("hopDistRows"));
+            pfrpTable::getInstance()->setFlowlet(par("flowletGap").doubleValue(), par("flowletCacheSize"));
+            pfrpTable::getInstance()->setPathCount(par("pathCount"), par("pathFile"));
+            pfrpTable::getInstance()->setDropStats(par("dropStats"));
+            pfrpTable::getInstance()->setTimingFile(par("timingFile"));
+            pfrpTable::getInstance()->setRecordFile(par("recordFile"), par("recordChunkSteps"));
 
             localPort = par("localPort");
             destPort = par("destPort");
@@ -91,6 +123,12 @@ namespace inet
             selfMsg = new cMessage("sendTimer");
             randDst = getDstNode();
         }
+        else if (stage == INITSTAGE_APPLICATION_LAYER)
+        {
+            // the routers report the delays of their links at INITSTAGE_NETWORK_LAYER
+            pfrpTable::getInstance()->setShortestPath(par("spMetric"));
+            pfrpTable::getInstance()->setDelayBound();
+        }
     }
 
     /**
@@ -99,25 +137,28 @@ namespace inet
      */
     int UdpPfrpApp::getDstNode()
     {
-        // get the current time in microseconds
-        auto now = std::chrono::system_clock::now();
-        auto now_us = std::chrono::time_point_cast<std::chrono::microseconds>(now);
-        auto value = now_us.time_since_epoch();
-        long micros = value.count();
-        // using microseconds as random number seeds
-        std::mt19937 gen(micros);
-        // get source node
-        string sender = getParentModule()->getFullName();
-        int senderNode = atoi(sender.c_str() + 1);
+        // draw from the module RNG, which is seeded by seed-0-mt, so the traffic matrix is reproducible
+        int senderNode = nodeIndex;
         int dst = senderNode;
         while (dst == senderNode)
         {
-            std::uniform_int_distribution<int> dist(0, nodeNum - 1);
-            dst = dist(gen);
+            dst = intuniform(0, nodeNum - 1);
         }
         return dst;
     }
 
+    /**
+     * @description: Get the seed of the simulation run, used to seed the next-hop sampling streams of pfrpTable.
+     * @return {uint64_t} seed-0-mt if it is set in omnetpp.ini, otherwise the run number
+     */
+    uint64_t UdpPfrpApp::getRunSeed()
+    {
+        const char *seed = getEnvir()->getConfig()->getConfigValue("seed-0-mt");
+        if (seed && *seed)
+            return strtoull(seed, nullptr, 10);
+        return getEnvir()->getConfigEx()->getActiveRunNumber();
+    }
+
     void UdpPfrpApp::finish()
     {
         ApplicationBase::finish();
@@ -162,31 +203,39 @@ namespace inet
 
     void UdpPfrpApp::sendPacket()
     {
-        string sender = getParentModule()->getFullName(); // current node(source node)
-        int senderNode = atoi(sender.c_str() + 1);
+        char prefix = getParentModule()->getName()[0]; // current node(source node)
 
-        string destName = "H" + to_string(randDst);
         // The name of the packet, in the format of
-        // "{source node}-{host node}-{routing protocol}-{packet number}-{current step}", such as H0-H5-pfrp-4387-0
+        // "{source node}-{host node}-{routing protocol}-{packet number}-{current step}", such as H0-H5-pfrp-4387-0,
+        // the destination has the prefix of the source, R for the merged PfrpNode, and vector nodes H[0] are named H0,
+        // simMode 3 appends the index of the path the packet is source-routed on, such as H0-H5-pfrpkp-4387-0-2
         int sendId = pfrpTable::getInstance()->getSendId();
-        string pkName = sender + "-" + destName + "-" + routingProtocol + "-" + to_string(sendId) + "-" + to_string(stepNum);
-        Packet *packet = new Packet(pkName.c_str());
+        char pkName[64];
+        int len = snprintf(pkName, sizeof(pkName), "%c%d-%c%d-%s-%d-%d", prefix, nodeIndex, prefix, randDst, routingProtocol.c_str(), sendId, stepNum);
+        if (simMode == 3)
+            snprintf(pkName + len, sizeof(pkName) - len, "-%d", pfrpTable::getInstance()->samplePath(nodeIndex, randDst));
+        Packet *packet = packetPool ? new UdpPfrpPacket(pkName) : new Packet(pkName);
         sendPacketId++;
 
         if (dontFragment)
             packet->addTag<FragmentationReq>()->setDontFragment(true);
-        const auto &payload = makeShared<ApplicationPacket>();
+        Ptr<ApplicationPacket> payload = packetPool ? makeShared<UdpPfrpPayload>() : makeShared<ApplicationPacket>();
 
         payload->setChunkLength(B((int)messageLength));
         payload->setSequenceNumber(numSent);
-        payload->addTag<CreationTimeTag>()->setCreationTime(simTime());
+        if (packetPool)
+            payload->addTag<UdpPfrpCreationTimeTag>()->setCreationTime(simTime());
+        else
+            payload->addTag<CreationTimeTag>()->setCreationTime(simTime());
         packet->insertAtBack(payload);
 
-        L3Address destAddr;
-        const char *dn = destName.c_str();
-        cStringTokenizer tokenizer(dn);
-        const char *token = tokenizer.nextToken();
-        L3AddressResolver().tryResolve(token, destAddr);
+        if (destAddr.isUnspecified())
+        {
+            // the destination of a node is fixed, so it is resolved once
+            char destName[16];
+            snprintf(destName, sizeof(destName), vectorNode ? "%c[%d]" : "%c%d", prefix, randDst);
+            L3AddressResolver().tryResolve(destName, destAddr);
+        }
         emit(packetSentSignal, packet);
 
         socket.sendTo(packet, destAddr, destPort); // send packet
@@ -216,17 +265,20 @@ namespace inet
             simtime_t timeC = simTime() - timerStep;
             if (timeC > stepTime)
             {
-                cout << "--------  step " << stepNum << "  Node " << getParentModule()->getFullName() << "  --------" << endl;
+                if (pfrpTelemetry::getInstance()->isEnabled(pfrpTelemetry::LEVEL_DEBUG))
+                {
+                    pfrpTelemetry::getInstance()->log(pfrpTelemetry::LEVEL_DEBUG, "--------  step " + to_string(stepNum) + "  Node " + getParentModule()->getFullName() + "  --------");
+                }
                 pfrpTable::getInstance()->pkNumRecord(sendPacketId, stepNum);
                 pfrpTable::getInstance()->stepEndRecord(stepNum, simTime().dbl());
 
-                if (simMode == 0)
+                if (simMode == 0 || simMode == 4)
                 {
-                    // Traditional algorithms, do not need to update the probabilistic routing table,
-                    // only need to clean up the remnants of state statistics
+                    // Traditional algorithms and the shortest-path baseline, do not need to update the probabilistic
+                    // routing table, only need to clean up the remnants of state statistics
                     pfrpTable::getInstance()->cleanPkctAndTps();
                 }
-                else if (simMode == 1 || simMode == 2)
+                else if (simMode == 1 || simMode == 2 || simMode == 3)
                 {
                     // DRL algorithms, need to update forwarding probability
                     pfrpTable::getInstance()->updateProb(stepNum);
@@ -238,10 +290,8 @@ namespace inet
             }
             sendPacket();
 
-            cMersenneTwister *mt;
             // Traffic generation method: limit upper and lower bounds, evenly distributed
-            cUniform un = cUniform(mt, 0.9 * sendInterval, 1.1 * sendInterval);
-            double interval = un.draw();
+            double interval = uniform(0.9 * sendInterval, 1.1 * sendInterval);
             simtime_t d = simTime() + interval;
             if (stopTime < SIMTIME_ZERO || d < stopTime)
             {
@@ -294,11 +344,9 @@ namespace inet
                 char *locPtr = NULL;
                 char *srcNode = strtok_r(msgName, "-", &locPtr);
                 char *dstNode = strtok_r(NULL, "-", &locPtr);
-                char *thisNode = (char *)getParentModule()->getName();
+                char thisPrefix = getParentModule()->getName()[0];
 
-                string thisN = thisNode;
-                string dstN = dstNode;
-                if (thisN == dstN)
+                if (dstNode[0] == thisPrefix && pfrpTable::parseNodeId(dstNode) == nodeIndex)
                 {
                     socket.processMessage(msg);
                 }
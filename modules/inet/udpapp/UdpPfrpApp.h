@@ -73,6 +73,11 @@ class INET_API UdpPfrpApp : public ApplicationBase, public UdpSocket::ICallback
     double survivalTime;
     int simMode;
     int fixedDst;
+    bool queueState;
+    bool packetPool = false; // allocate packets from the pools of UdpPfrpPool.h
+    L3Address destAddr;      // address of randDst, resolved on the first send
+    bool vectorNode = false; // whether the node is an element of a vector submodule, H[i] instead of Hi
+    int nodeIndex = -1;      // ID of the node
 
     UdpSocket socket;
     cMessage *selfMsg = nullptr;
@@ -106,6 +111,7 @@ class INET_API UdpPfrpApp : public ApplicationBase, public UdpSocket::ICallback
     virtual void socketClosed(UdpSocket *socket) override;
 
     int getDstNode();
+    uint64_t getRunSeed();
 
   public:
     UdpPfrpApp() {}
@@ -0,0 +1,88 @@
+/***
+ * @Date         : 2026-10-19 17:00:00
+ * @FilePath     : RL4Net++/modules/inet/udpapp/UdpPfrpPool.h
+ * @Description  : Pooled allocation of the packets generated by UdpPfrpApp. The packet, its payload chunk and
+ *                 its creation time tag are subclasses with class-specific operator new/delete backed by free
+ *                 lists, so wherever INET destroys them (the sink, a drop, an ICMP error) their storage returns
+ *                 to the pool and is reused by the next send of any source. Ownership is unchanged, the objects
+ *                 are created, passed and deleted exactly as the plain INET classes. Copies made by dup() are
+ *                 plain INET objects and are allocated as usual.
+ */
+
+#ifndef __INET_UDPPFRPPOOL_H
+#define __INET_UDPPFRPPOOL_H
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+#include "inet/applications/base/ApplicationPacket_m.h"
+#include "inet/common/TimeTag_m.h"
+#include "inet/common/packet/Packet.h"
+
+namespace inet {
+
+/**
+ * Free list of the blocks of one pooled class, shared by all modules. The simulation is single-threaded,
+ * so no lock is taken. At most maxBlocks blocks are kept, the rest is returned to the heap.
+ */
+template <typename T>
+class UdpPfrpFreeList {
+  public:
+    static void *allocate(size_t size)
+    {
+        std::vector<void *> &free = blocks();
+        if (size != sizeof(T) || free.empty())
+            return ::operator new(size);
+        void *block = free.back();
+        free.pop_back();
+        return block;
+    }
+
+    static void release(void *block, size_t size)
+    {
+        std::vector<void *> &free = blocks();
+        if (size != sizeof(T) || free.size() >= maxBlocks) {
+            ::operator delete(block);
+            return;
+        }
+        free.push_back(block);
+    }
+
+  private:
+    static const size_t maxBlocks = 65536;
+
+    // never destroyed, packets may still be deleted while static objects are torn down
+    static std::vector<void *> &blocks()
+    {
+        static std::vector<void *> *free = new std::vector<void *>();
+        return *free;
+    }
+};
+
+// Packet of UdpPfrpApp with pooled storage.
+class INET_API UdpPfrpPacket : public Packet {
+  public:
+    explicit UdpPfrpPacket(const char *name) : Packet(name) {}
+
+    static void *operator new(size_t size) { return UdpPfrpFreeList<UdpPfrpPacket>::allocate(size); }
+    static void operator delete(void *block, size_t size) { UdpPfrpFreeList<UdpPfrpPacket>::release(block, size); }
+};
+
+// Payload of UdpPfrpApp with pooled storage, serialized as an ApplicationPacket.
+class INET_API UdpPfrpPayload : public ApplicationPacket {
+  public:
+    static void *operator new(size_t size) { return UdpPfrpFreeList<UdpPfrpPayload>::allocate(size); }
+    static void operator delete(void *block, size_t size) { UdpPfrpFreeList<UdpPfrpPayload>::release(block, size); }
+};
+
+// Creation time tag of the payload of UdpPfrpApp with pooled storage.
+class INET_API UdpPfrpCreationTimeTag : public CreationTimeTag {
+  public:
+    static void *operator new(size_t size) { return UdpPfrpFreeList<UdpPfrpCreationTimeTag>::allocate(size); }
+    static void operator delete(void *block, size_t size) { UdpPfrpFreeList<UdpPfrpCreationTimeTag>::release(block, size); }
+};
+
+} // namespace inet
+
+#endif // ifndef __INET_UDPPFRPPOOL_H
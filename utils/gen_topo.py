@@ -0,0 +1,278 @@
+"""
+Date         : 2026-10-19 19:00:00
+FilePath     : RL4Net++/utils/gen_topo.py
+Description  : Generate synthetic topologies for scaling studies: N x M grids, k-ary fat-trees, Waxman random graphs
+               and Barabasi-Albert graphs. Each topology is written as config/ned/<name>.ned and the matching initial
+               probability file config/ned/<name>.txt, with equal forwarding probabilities to every neighbor.
+               Random topologies are drawn from --seed, so the same arguments always give the same files.
+               With --binary the probability file is the sparse config/ned/<name>.pfrb instead, which stays
+               small for tens of thousands of nodes.
+
+               usage: python utils/gen_topo.py grid --rows 100 --cols 100 --vector
+                      python utils/gen_topo.py fattree --k 8
+                      python utils/gen_topo.py waxman --nodes 5000 --degree 4 --seed 1 --vector
+                      python utils/gen_topo.py ba --nodes 20000 --m 2 --seed 1 --vector --binary --no-static-routes
+"""
+
+import argparse
+import math
+import random
+
+import numpy as np
+
+from get_ned import write_ned
+from prob_to_bin import write_prob_bin
+
+
+def grid_edges(rows: int, cols: int) -> tuple:
+    """Links of a rows x cols grid, node r * cols + c is linked to its right and lower neighbors.
+
+    Args:
+        rows (int): number of rows
+        cols (int): number of columns
+
+    Returns:
+        tuple: number of nodes, links (i, j) with i < j
+    """
+    edges = []
+    for r in range(rows):
+        for c in range(cols):
+            node = r * cols + c
+            if c + 1 < cols:
+                edges.append((node, node + 1))
+            if r + 1 < rows:
+                edges.append((node, node + cols))
+    return rows * cols, edges
+
+
+def fattree_edges(k: int) -> tuple:
+    """Links of the switches of a k-ary fat-tree. Nodes are the (k/2)^2 core switches, then for every pod
+    its k/2 aggregation and k/2 edge switches. Every switch is a router with its own host in the generated
+    network, so traffic is sent from every level of the tree.
+
+    Args:
+        k (int): number of ports of a switch, even
+
+    Returns:
+        tuple: number of nodes, links (i, j) with i < j
+    """
+    if k < 2 or k % 2:
+        raise ValueError("k of a fat-tree must be even and at least 2")
+    half = k // 2
+    core_num = half * half
+    edges = []
+    for pod in range(k):
+        agg_base = core_num + pod * k
+        edge_base = agg_base + half
+        for a in range(half):
+            for c in range(half):
+                edges.append((a * half + c, agg_base + a))
+            for e in range(half):
+                edges.append((agg_base + a, edge_base + e))
+    return core_num + k * k, edges
+
+
+def waxman_edges(node_num: int, alpha: float, beta: float, degree: float, seed: int) -> tuple:
+    """Links of a Waxman graph over nodes placed uniformly in the unit square, u and v are linked with
+    probability beta * exp(-d(u, v) / (alpha * L)), where L is the diagonal of the square. Components are
+    joined afterwards, so the graph is connected.
+
+    Args:
+        node_num (int):     number of nodes
+        alpha (float):      share of L over which the link probability decays
+        beta (float):       link probability of close nodes, ignored when degree is given
+        degree (float):     target average degree, beta is scaled to reach it
+        seed (int):         seed of the placement and of the links
+
+    Returns:
+        tuple: number of nodes, links (i, j) with i < j
+    """
+    rng = np.random.default_rng(seed)
+    pos = rng.random((node_num, 2))
+    scale = alpha * math.sqrt(2)
+    if degree:
+        # expected degree (n - 1) * beta * E[exp(-d / scale)], with the expectation estimated on random pairs
+        pairs = rng.integers(0, node_num, (2, 100000))
+        mean_prob = np.exp(-np.linalg.norm(pos[pairs[0]] - pos[pairs[1]], axis=1) / scale).mean()
+        beta = min(1.0, degree / ((node_num - 1) * mean_prob))
+    edges = []
+    for i in range(node_num - 1):
+        dist = np.linalg.norm(pos[i + 1 :] - pos[i], axis=1)
+        linked = np.nonzero(rng.random(len(dist)) < beta * np.exp(-dist / scale))[0]
+        edges.extend((i, i + 1 + int(j)) for j in linked)
+    return node_num, connect_components(node_num, edges, random.Random(seed))
+
+
+def ba_edges(node_num: int, m: int, seed: int) -> tuple:
+    """Links of a Barabasi-Albert graph. The first m + 1 nodes form a clique, every later node links to m
+    distinct earlier nodes chosen with probability proportional to their degree.
+
+    Args:
+        node_num (int): number of nodes
+        m (int):        links of every new node
+        seed (int):     seed of the attachment
+
+    Returns:
+        tuple: number of nodes, links (i, j) with i < j
+    """
+    if m < 1 or node_num <= m:
+        raise ValueError("a Barabasi-Albert graph needs m >= 1 and more than m nodes")
+    rng = random.Random(seed)
+    edges = [(i, j) for i in range(m + 1) for j in range(i + 1, m + 1)]
+    # every node appears once per link, so a uniform draw is proportional to the degree
+    ends = [node for edge in edges for node in edge]
+    for v in range(m + 1, node_num):
+        targets = set()
+        while len(targets) < m:
+            targets.add(ends[rng.randrange(len(ends))])
+        for t in sorted(targets):
+            edges.append((t, v))
+            ends.extend((t, v))
+    return node_num, edges
+
+
+def connect_components(node_num: int, edges: list, rng: random.Random) -> list:
+    """Join the components of a graph by linking a random node of each to a random node of the previous one.
+
+    Args:
+        node_num (int):         number of nodes
+        edges (list):           links (i, j) with i < j
+        rng (random.Random):    source of the chosen nodes
+
+    Returns:
+        list: links with the joining links added
+    """
+    parent = list(range(node_num))
+
+    def find(x):
+        while parent[x] != x:
+            parent[x] = parent[parent[x]]
+            x = parent[x]
+        return x
+
+    for i, j in edges:
+        parent[find(i)] = find(j)
+    components = {}
+    for node in range(node_num):
+        components.setdefault(find(node), []).append(node)
+    members = list(components.values())
+    for prev, comp in zip(members, members[1:]):
+        u, v = rng.choice(prev), rng.choice(comp)
+        edges.append((min(u, v), max(u, v)))
+    return edges
+
+
+def neighbor_weights(node_num: int, edges: list) -> list:
+    """Forwarding weight of every node to each of its neighbors, 100 // degree and at least 1,
+    since pfrpTable normalizes by the sum of the row.
+
+    Args:
+        node_num (int):     number of router nodes
+        edges (list):       links (i, j) with i < j
+
+    Returns:
+        list: weight of every node
+    """
+    degrees = [0] * node_num
+    for i, j in edges:
+        degrees[i] += 1
+        degrees[j] += 1
+    return [max(1, 100 // d) if d else 0 for d in degrees]
+
+
+def write_prob_file(topo_name: str, node_num: int, edges: list) -> None:
+    """Write the initial probability .txt file row by row, the comma-separated node_num x node_num matrix
+    read by pfrpTable::getProb.
+
+    Args:
+        topo_name (str):    name of network topology
+        node_num (int):     number of router nodes
+        edges (list):       links (i, j) with i < j
+    """
+    weights = neighbor_weights(node_num, edges)
+    neighbors = [[] for _ in range(node_num)]
+    for i, j in edges:
+        neighbors[i].append(j)
+        neighbors[j].append(i)
+    with open(f"config/ned/{topo_name}.txt", "w") as f:
+        print("\033[0;33m Starting Generating config/ned/" + topo_name + ".txt \033[0m")
+        for i in range(node_num):
+            row = ["0"] * node_num
+            for j in neighbors[i]:
+                row[j] = str(weights[i])
+            f.write(("," if i else "") + ",".join(row))
+    print(f"\033[0;32m {topo_name}.txt was successfully generated! \033[0m")
+
+
+def write_prob_bin_file(topo_name: str, node_num: int, edges: list) -> None:
+    """Write the initial probabilities as the sparse binary routing file config/ned/<topo_name>.pfrb.
+
+    Args:
+        topo_name (str):    name of network topology
+        node_num (int):     number of router nodes
+        edges (list):       links (i, j) with i < j
+    """
+    weights = np.array(neighbor_weights(node_num, edges), dtype=np.int32)
+    ends = np.array(edges, dtype=np.int32).reshape(-1, 2)
+    src = np.concatenate((ends[:, 0], ends[:, 1]))
+    dst = np.concatenate((ends[:, 1], ends[:, 0]))
+    write_prob_bin(f"config/ned/{topo_name}.pfrb", node_num, src, dst, weights[src])
+    print(f"\033[0;32m {topo_name}.pfrb was successfully generated! \033[0m")
+
+
+def main() -> None:
+    parser = argparse.ArgumentParser(description="Generate a synthetic topology and its initial probability file.")
+    parser.add_argument("kind", choices=["grid", "fattree", "waxman", "ba"], help="family of the topology")
+    parser.add_argument("--rows", type=int, default=10, help="rows of a grid")
+    parser.add_argument("--cols", type=int, default=10, help="columns of a grid")
+    parser.add_argument("--k", type=int, default=4, help="ports of a fat-tree switch")
+    parser.add_argument("--nodes", type=int, default=100, help="nodes of a Waxman or Barabasi-Albert graph")
+    parser.add_argument("--alpha", type=float, default=0.15, help="distance decay of a Waxman graph")
+    parser.add_argument("--beta", type=float, default=0.4, help="link probability of a Waxman graph")
+    parser.add_argument("--degree", type=float, default=0, help="target average degree of a Waxman graph, overrides --beta")
+    parser.add_argument("--m", type=int, default=2, help="links of every new node of a Barabasi-Albert graph")
+    parser.add_argument("--seed", type=int, default=0, help="seed of random topologies")
+    parser.add_argument("--name", default="", help="name of the network, derived from the arguments by default")
+    parser.add_argument("--merged", action="store_true", help="write PfrpNode routers running the traffic app")
+    parser.add_argument("--vector", action="store_true", help="write vector submodules connected in loops, for large topologies")
+    parser.add_argument("--binary", action="store_true", help="write the sparse binary probability file .pfrb instead of .txt")
+    parser.add_argument("--no-static-routes", action="store_true", help="let the configurator assign addresses only, for pfrp runs")
+    args = parser.parse_args()
+
+    if args.kind == "grid":
+        node_num, edges = grid_edges(args.rows, args.cols)
+        name = f"Grid{args.rows}x{args.cols}"
+    elif args.kind == "fattree":
+        node_num, edges = fattree_edges(args.k)
+        name = f"FatTree{args.k}"
+    elif args.kind == "waxman":
+        node_num, edges = waxman_edges(args.nodes, args.alpha, args.beta, args.degree, args.seed)
+        name = f"Waxman{args.nodes}s{args.seed}"
+    else:
+        node_num, edges = ba_edges(args.nodes, args.m, args.seed)
+        name = f"Ba{args.nodes}m{args.m}s{args.seed}"
+    topo_name = args.name or name
+
+    edges = sorted(set(edges))
+    grouped = [[] for _ in range(node_num)]
+    for edge in edges:
+        grouped[edge[0]].append(edge)
+    print(f"\033[0;33m Topo: {topo_name} has {node_num} nodes and {len(edges)} edges. \033[0m")
+    edge_ext = "pfrb" if args.binary else "txt"
+    write_ned(
+        topo_name,
+        node_num,
+        grouped,
+        merged=args.merged,
+        vector=args.vector,
+        edge_ext=edge_ext,
+        static_routes=not args.no_static_routes,
+    )
+    if args.binary:
+        write_prob_bin_file(topo_name, node_num, edges)
+    else:
+        write_prob_file(topo_name, node_num, edges)
+
+
+if __name__ == "__main__":
+    main()
@@ -7,21 +7,43 @@ FilePath     : /home/lgc/test/RL4Net++/utils/get_ned.py
 Description  : Convert a gml file to a network topology file for OMNeT++ simulation based on the URL of the gml file.
 """
 
-import requests
+import argparse
+import os
 import re
 
 
-def get_omnetpp_ned(gml_url: str) -> None:
-    """Reads gml file information from a given URL.
+def read_gml(gml_path: str) -> str:
+    """Reads a gml file from a local path, or downloads it when the path is a URL.
 
     Args:
-        gml_url (str): URL of the gml file
+        gml_path (str): local path or URL of the gml file
+
+    Returns:
+        str: content of the gml file
+    """
+    if os.path.exists(gml_path):
+        with open(gml_path, "r") as gml_file:
+            return gml_file.read()
+    import requests
+
+    return requests.get(gml_path).content.decode()
+
+
+def get_omnetpp_ned(gml_url: str, merged: bool = False, vector: bool = False, static_routes: bool = True) -> None:
+    """Reads gml file information from a given URL or local path.
+
+    Args:
+        gml_url (str):                  URL or local path of the gml file
+        merged (bool, optional):        model each site as one PfrpNode instead of a host attached to a router. Defaults to False.
+        vector (bool, optional):        write the nodes as vector submodules connected in loops over the links of the
+                                        probability file, for large topologies. Defaults to False.
+        static_routes (bool, optional): let the configurator compute static routes, see write_ned. Defaults to True.
     """
     if not gml_url:
         print("\033[0;31m Error! gml_url is None! \033[0m")
         return
-    topo_name = re.search(r"\/(\w+)\.gml", gml_url)[1]
-    gml_info = requests.get(gml_url).content.decode()
+    topo_name = re.search(r"(\w+)\.gml$", gml_url)[1]
+    gml_info = read_gml(gml_url)
     node_info_strs = re.findall(r"node \[.*?\]", gml_info, re.S)
     node_num = len(node_info_strs)
     edge_info_str = re.findall(r"edge \[.*?\]", gml_info, re.S)
@@ -42,31 +64,43 @@ def get_omnetpp_ned(gml_url: str) -> None:
                 (int(info["target"]), int(info["source"])),
             )
         )
-    edges = sorted(edges, key=lambda x: (x[0], x[1]))
-    bothway_edges = sorted(bothway_edges, key=lambda x: (x[0], x[1]))
-    edges = [
-        [edge for edge in edges if edge[0] == i] for i in range(int(edges[-1][0]) + 1)
-    ]
-    bothway_edges = [
-        [bothway_edge for bothway_edge in bothway_edges if bothway_edge[0] == i]
-        for i in range(int(bothway_edges[-1][0]) + 1)
-    ]
+    edges = group_edges(sorted(edges, key=lambda x: (x[0], x[1])))
+    bothway_edges = group_edges(sorted(bothway_edges, key=lambda x: (x[0], x[1])))
     print(
         f"\033[0;33m Topo: {topo_name} has {node_num} nodes and {len(edge_info)} edges. \033[0m"
     )
-    write_ned(topo_name, node_num, edges)
+    write_ned(topo_name, node_num, edges, merged=merged, vector=vector, static_routes=static_routes)
     write_init_prob_file(topo_name, node_num, bothway_edges)
     print(
         f"\033[0;32m Congratulations! config/ned/{topo_name}.ned and config/ned/{topo_name}.txt were successfully generated!  \033[0m"
     )
 
 
+def group_edges(edges: list) -> list:
+    """Groups sorted links by their source node.
+
+    Args:
+        edges (list): links (source, target) sorted by source
+
+    Returns:
+        list: for each node up to the last source, the links leaving it
+    """
+    grouped = [[] for _ in range(int(edges[-1][0]) + 1)] if edges else []
+    for edge in edges:
+        grouped[edge[0]].append(edge)
+    return grouped
+
+
 def write_ned(
     topo_name: str,
     node_num: int,
     edges: list,
     bandwidth: float = 1,
     link_delay: float = 0.002,
+    merged: bool = False,
+    vector: bool = False,
+    edge_ext: str = "txt",
+    static_routes: bool = True,
 ) -> None:
     """Converts the read information into a .ned file.
 
@@ -76,18 +110,35 @@ def write_ned(
         edges (list):                   network topology link information, where each element represents a bi-directional link
         bandwidth (float, optional):    bandwidth of the network. Defaults to 1.
         link_delay (float, optional):   delay of network link. Defaults to 0.002.
+        merged (bool, optional):        write PfrpNode routers running the traffic app instead of StandardHost
+                                        and Router pairs. Defaults to False.
+        vector (bool, optional):        write H[nodeNum] and R[nodeNum] vector submodules connected in loops over
+                                        the links of config/ned/<topo_name>.txt, so the file size does not grow
+                                        with the topology. Defaults to False.
+        edge_ext (str, optional):       extension of the probability file the vector network reads its links from,
+                                        txt or the sparse binary pfrb. Defaults to "txt".
+        static_routes (bool, optional): let the configurator compute static routes by default. pfrp runs never use
+                                        them, False makes the configurator assign addresses only, unless
+                                        omnetpp.ini sets addStaticRoutes for an OSPF or RIP baseline. Defaults to True.
     """
 
     with open(f"config/ned/{topo_name}.ned", "w") as f:
         print("\033[0;33m Starting Generating config/ned/" + topo_name + ".ned \033[0m")
         f.write("import inet.networklayer.configurator.ipv4.Ipv4NetworkConfigurator;\n")
-        f.write("import inet.node.inet.StandardHost;\n")
-        f.write("import inet.node.inet.Router;\n")
-        f.write("import ned.DatarateChannel;\n")
-        f.write("import inet.node.ethernet.Eth1G;\n\n")
+        if merged:
+            f.write("import inet.node.inet.PfrpNode;\n")
+            f.write("import ned.DatarateChannel;\n\n")
+        else:
+            f.write("import inet.node.inet.StandardHost;\n")
+            f.write("import inet.node.inet.Router;\n")
+            f.write("import ned.DatarateChannel;\n")
+            f.write("import inet.node.ethernet.Eth1G;\n\n")
         f.write(f"network {topo_name}\n")
         f.write("{\n")
         f.write("    parameters:\n")
+        if vector:
+            f.write(f"        int nodeNum = {node_num};\n")
+            f.write(f'        string edgeFile = "ned/{topo_name}.{edge_ext}";\n')
         f.write('        @display("p=10,10;b=712,152");\n')
         f.write("    types:\n")
         f.write("        channel C extends DatarateChannel\n")
@@ -96,8 +147,10 @@ def write_ned(
         f.write(f"            datarate = {bandwidth}Mbps;\n")
         f.write("        }\n")
         f.write("    submodules:\n")
-        for node_index in range(node_num):
-            f.write(f"        H{node_index}" + ": StandardHost {\n")
+        host_names = ["H[nodeNum]"] if vector else [f"H{i}" for i in range(node_num)]
+        router_names = ["R[nodeNum]"] if vector else [f"R{i}" for i in range(node_num)]
+        for host_name in host_names if not merged else []:
+            f.write(f"        {host_name}" + ": StandardHost {\n")
             f.write("            parameters:\n")
             f.write("                forwarding = true;\n")
             f.write('                @display("p=250,150;i=device/laptop");\n')
@@ -107,27 +160,47 @@ def write_ned(
         f.write("        configurator: Ipv4NetworkConfigurator {\n")
         f.write("            parameters:\n")
         f.write("                addDefaultRoutes = false;\n")
+        if not static_routes:
+            f.write("                addStaticRoutes = default(false);\n")
         f.write('                @display("p=100,100;is=s");\n')
         f.write("        }\n")
-        for node_index in range(node_num):
-            f.write(f"        R{node_index}" + ": Router {\n")
+        for router_name in router_names:
+            if merged:
+                f.write(f"        {router_name}" + ": PfrpNode {\n")
+                f.write("            parameters:\n")
+                f.write('                @display("p=250,200");\n')
+                f.write("        }\n\n")
+                continue
+            f.write(f"        {router_name}" + ": Router {\n")
             f.write("            parameters:\n")
             f.write("                hasOspf = true;\n")
             f.write("                // hasRip = true;\n")
             f.write('                @display("p=250,200");\n')
             f.write("        }\n\n")
         f.write("        connections:\n")
-        for edge_ in edges:
-            for edge in edge_:
-                f.write(
-                    f"            R{edge[0]}.pppg++ <--> C <--> R{edge[1]}.pppg++;\n"
-                )
-            f.write("\n")
-        f.write("\n")
-        for node_index in range(node_num):
+        if vector:
+            # links in the order of pfrpTable, see modules/inet/node/PfrpNedFunctions.cc
+            f.write("            for k=0..pfrpEdgeCount(edgeFile)-1 {\n")
             f.write(
-                f"            R{node_index}.ethg++ <--> Eth1G <--> H{node_index}.ethg++;\n"
+                "                R[pfrpEdgeSrc(edgeFile, k)].pppg++ <--> C <--> R[pfrpEdgeDst(edgeFile, k)].pppg++;\n"
             )
+            f.write("            }\n")
+            if not merged:
+                f.write("            for i=0..nodeNum-1 {\n")
+                f.write("                R[i].ethg++ <--> Eth1G <--> H[i].ethg++;\n")
+                f.write("            }\n")
+        else:
+            for edge_ in edges:
+                for edge in edge_:
+                    f.write(
+                        f"            R{edge[0]}.pppg++ <--> C <--> R{edge[1]}.pppg++;\n"
+                    )
+                f.write("\n")
+            f.write("\n")
+            for node_index in range(node_num if not merged else 0):
+                f.write(
+                    f"            R{node_index}.ethg++ <--> Eth1G <--> H{node_index}.ethg++;\n"
+                )
         f.write("}")
     print(
         "\033[0;32m config/ned/"
@@ -145,16 +218,10 @@ def write_init_prob_file(topo_name: str, node_num: int, bothway_edges: list) ->
         node_num (int):         number of router nodes
         bothway_edges (list):   network topology link information, where each element represents a unidirectional link
     """
-    init_prob = sum(
-        (
-            [
-                100 // len(edge) if i in [t[1] for t in edge] else 0
-                for i in range(node_num)
-            ]
-            for edge in bothway_edges
-        ),
-        [],
-    )
+    init_prob = [0] * (node_num * node_num)
+    for edge in bothway_edges:
+        for t in edge:
+            init_prob[t[0] * node_num + t[1]] = 100 // len(edge)
     with open(f"config/ned/{topo_name}.txt", "w") as f:
         print("\033[0;33m Starting Generating config/ned/" + topo_name + ".txt \033[0m")
         f.write(",".join(str(i) for i in init_prob))
@@ -162,5 +229,10 @@ def write_init_prob_file(topo_name: str, node_num: int, bothway_edges: list) ->
 
 
 if __name__ == "__main__":
-    gml_url = "http://topology-zoo.org/files/Gridnet.gml"
-    get_omnetpp_ned(gml_url)
+    parser = argparse.ArgumentParser(description="Convert a gml file to a NED file and an initial probability file.")
+    parser.add_argument("gml", nargs="?", default="http://topology-zoo.org/files/Gridnet.gml", help="URL or local path of the gml file")
+    parser.add_argument("--merged", action="store_true", help="write PfrpNode routers running the traffic app")
+    parser.add_argument("--vector", action="store_true", help="write vector submodules connected in loops, for large topologies")
+    parser.add_argument("--no-static-routes", action="store_true", help="let the configurator assign addresses only, for pfrp runs")
+    args = parser.parse_args()
+    get_omnetpp_ned(args.gml, merged=args.merged, vector=args.vector, static_routes=not args.no_static_routes)
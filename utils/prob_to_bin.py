@@ -0,0 +1,74 @@
+"""
+Date         : 2026-10-19 20:00:00
+FilePath     : RL4Net++/utils/prob_to_bin.py
+Description  : Convert a dense comma-separated initial probability file (.txt) into the sparse binary routing file
+               (.pfrb) memory-mapped by pfrpTable, see modules/inet/ipv4/pfrpProbFile.h for the layout. Set
+               routingFileName in omnetpp.ini to the .pfrb file to load it.
+
+               usage: python utils/prob_to_bin.py config/ned/Gridnet.txt [config/ned/Gridnet.pfrb]
+"""
+
+import sys
+
+import numpy as np
+
+HEADER_DTYPE = np.dtype(
+    [
+        ("magic", "S4"),
+        ("version", "<u4"),
+        ("nodeNum", "<u4"),
+        ("entryNum", "<u4"),
+        ("reserved", "<u4", (4,)),
+    ]
+)
+ENTRY_DTYPE = np.dtype([("src", "<i4"), ("dst", "<i4"), ("prob", "<i4")])
+
+
+def write_prob_bin(bin_path: str, node_num: int, src, dst, prob) -> None:
+    """Write the nonzero entries of a routing matrix as a sparse binary routing file.
+
+    Args:
+        bin_path (str):     path of the .pfrb file
+        node_num (int):     number of nodes of the topology
+        src (array):        rows of the entries
+        dst (array):        columns of the entries
+        prob (array):       positive weights of the entries
+    """
+    entries = np.empty(len(src), dtype=ENTRY_DTYPE)
+    entries["src"], entries["dst"], entries["prob"] = src, dst, prob
+    # pfrpTable numbers the links in the order of the entries, which must be sorted by (src, dst)
+    entries.sort(order=["src", "dst"])
+    header = np.zeros(1, dtype=HEADER_DTYPE)
+    header["magic"], header["version"] = b"PFRB", 1
+    header["nodeNum"], header["entryNum"] = node_num, len(entries)
+    with open(bin_path, "wb") as f:
+        f.write(header.tobytes())
+        f.write(entries.tobytes())
+
+
+def convert(txt_path: str, bin_path: str) -> None:
+    """Convert a dense probability file into a sparse binary routing file, checking its dimensions.
+
+    Args:
+        txt_path (str): path of the comma-separated node_num x node_num file
+        bin_path (str): path of the .pfrb file
+    """
+    with open(txt_path, "r") as f:
+        values = np.array([v for v in f.read().split(",") if v.strip()], dtype=np.int32)
+    node_num = int(round(len(values) ** 0.5))
+    if node_num * node_num != len(values):
+        raise ValueError(f"{txt_path} has {len(values)} values, which is not node_num x node_num")
+    matrix = values.reshape(node_num, node_num)
+    if (matrix < 0).any() or matrix.diagonal().any() or ((matrix > 0) != (matrix.T > 0)).any():
+        raise ValueError(f"{txt_path} must be non-negative, with an empty diagonal and bi-directional links")
+    src, dst = np.nonzero(matrix)
+    write_prob_bin(bin_path, node_num, src, dst, matrix[src, dst])
+    print(f"\033[0;32m {bin_path} was written with {node_num} nodes and {len(src) // 2} links. \033[0m")
+
+
+if __name__ == "__main__":
+    if len(sys.argv) < 2:
+        print("usage: python utils/prob_to_bin.py <file.txt> [<file.pfrb>]")
+        sys.exit(1)
+    txt = sys.argv[1]
+    convert(txt, sys.argv[2] if len(sys.argv) > 2 else txt.rsplit(".", 1)[0] + ".pfrb")
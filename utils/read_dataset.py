@@ -0,0 +1,134 @@
+"""
+Date         : 2026-10-19 14:00:00
+FilePath     : RL4Net++/utils/read_dataset.py
+Description  : Stream the per-step dataset recorded by pfrpTable (recordFile in omnetpp.ini) without loading it into
+               memory. The index "<prefix>.pfri" and every chunk of "<prefix>.pfrd" are memory-mapped, see
+               modules/inet/ipv4/pfrpRecorder.h for the layout.
+
+               usage: python utils/read_dataset.py <prefix>
+"""
+
+import sys
+
+import numpy as np
+
+STATE, ACTION, REWARD = 0, 1, 2
+STREAM_NAMES = {STATE: "state", ACTION: "action", REWARD: "reward"}
+VALUE_TYPES = {STATE: np.float64, ACTION: np.int32, REWARD: np.float64}
+# in simMode 3 (K shortest paths) an action row is the split weight of every path instead of the nodeNum x nodeNum
+# table, so its width is the number of paths and its values are float64
+PATH_MODE = 3
+
+HEADER_DTYPE = np.dtype(
+    [
+        ("magic", "S4"),
+        ("version", "<u4"),
+        ("nodeNum", "<i4"),
+        ("simMode", "<i4"),
+        ("chunkRows", "<u4"),
+        ("reserved", "<u4", (11,)),
+    ]
+)
+CHUNK_DTYPE = np.dtype(
+    [
+        ("stream", "<u4"),
+        ("rows", "<u4"),
+        ("width", "<u4"),
+        ("firstStep", "<i4"),
+        ("offset", "<u8"),
+        ("bytes", "<u8"),
+    ]
+)
+
+
+class PfrpDataset:
+    """Memory-mapped reader of a recorded run."""
+
+    def __init__(self, prefix):
+        """open the index of a recorded run
+
+        Args:
+            prefix (string): recordFile of the run, without the .pfrd/.pfri extension
+        """
+        self.data_path = prefix + ".pfrd"
+        index = np.memmap(prefix + ".pfri", dtype=np.uint8, mode="r")
+        self.header = index[: HEADER_DTYPE.itemsize].view(HEADER_DTYPE)[0]
+        if self.header["magic"] != b"PFRI":
+            raise ValueError(f"{prefix}.pfri is not a pfrpTable dataset index")
+        # a live run may have appended a partial entry, only complete entries are read
+        body = index[HEADER_DTYPE.itemsize :]
+        body = body[: len(body) // CHUNK_DTYPE.itemsize * CHUNK_DTYPE.itemsize]
+        self.chunks = body.view(CHUNK_DTYPE)
+        self.node_num = int(self.header["nodeNum"])
+        self.sim_mode = int(self.header["simMode"])
+        self.value_types = dict(VALUE_TYPES)
+        if self.sim_mode == PATH_MODE:
+            self.value_types[ACTION] = np.float64
+
+    def iter_chunks(self, stream):
+        """iterate over the chunks of a stream in step order
+
+        Args:
+            stream (int): STATE, ACTION or REWARD
+
+        Yields:
+            tuple: (steps, values), steps has shape (rows,), values has shape (width, rows) and is a memory map,
+                   so that a column values[i] is read from disk only when it is used
+        """
+        for chunk in self.chunks[self.chunks["stream"] == stream]:
+            rows, width, offset = int(chunk["rows"]), int(chunk["width"]), int(chunk["offset"])
+            step_bytes = (rows * 4 + 7) // 8 * 8
+            steps = np.memmap(self.data_path, dtype=np.int32, mode="r", offset=offset, shape=(rows,))
+            values = np.memmap(
+                self.data_path,
+                dtype=self.value_types[stream],
+                mode="r",
+                offset=offset + step_bytes,
+                shape=(width, rows),
+            )
+            yield steps, values
+
+    def iter_steps(self, stream):
+        """iterate over the rows of a stream one step at a time
+
+        Yields:
+            tuple: (step, row), row has the width of the stream
+        """
+        for steps, values in self.iter_chunks(stream):
+            for r, step in enumerate(steps):
+                yield int(step), np.asarray(values[:, r])
+
+    def column(self, stream, index):
+        """read a single column of a stream across all steps, e.g. the traffic of one OD pair
+
+        Returns:
+            tuple: (steps, values) as 1-d arrays
+        """
+        parts = [(np.asarray(s), np.asarray(v[index])) for s, v in self.iter_chunks(stream)]
+        if not parts:
+            return np.empty(0, np.int32), np.empty(0, self.value_types[stream])
+        return np.concatenate([p[0] for p in parts]), np.concatenate([p[1] for p in parts])
+
+    def iter_transitions(self):
+        """join the streams on the step number
+
+        Yields:
+            tuple: (step, state, action, reward) of the steps present in all three streams
+        """
+        # states and actions are recorded together, in step order; rewards may finish out of order but are small
+        rewards = dict(self.iter_steps(REWARD))
+        for (step, state), (_, action) in zip(self.iter_steps(STATE), self.iter_steps(ACTION)):
+            if step in rewards:
+                yield step, state, action, rewards.pop(step)
+
+
+if __name__ == "__main__":
+    if len(sys.argv) != 2:
+        print("usage: python utils/read_dataset.py <prefix>")
+        sys.exit(1)
+    dataset = PfrpDataset(sys.argv[1])
+    print(f"nodeNum: {dataset.node_num}  simMode: {dataset.sim_mode}  chunks: {len(dataset.chunks)}")
+    for stream, name in STREAM_NAMES.items():
+        chunks = dataset.chunks[dataset.chunks["stream"] == stream]
+        if len(chunks):
+            print(f"{name:<7} steps: {int(chunks['rows'].sum()):<6} width: {int(chunks['width'][0])}")